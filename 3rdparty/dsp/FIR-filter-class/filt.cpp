@@ -60,6 +60,8 @@ Filter::Filter(filterType filt_t, int num_taps, double Fs, double Fx)
 	m_Fx = Fx;
 	m_lambda = M_PI * Fx / (Fs/2);
 	m_taps = m_sr = NULL; //SSE
+	m_step_f = m_edge_delta = NULL; //SSE
+	m_edge_time = NULL; //SSE
 	if( Fs <= 0 ) ECODE(-1);
 	if( Fx <= 0 || Fx >= Fs/2 ) ECODE(-2);
 	if( m_num_taps <= 0 || m_num_taps > MAX_NUM_FILTER_TAPS ) ECODE(-3);
@@ -74,6 +76,7 @@ Filter::Filter(filterType filt_t, int num_taps, double Fs, double Fx)
 	if( m_filt_t == LPF ) designLPF();
 	else if( m_filt_t == HPF ) designHPF();
 	else ECODE(-5);
+	designSteps(); //SSE
 
 	return;
 }
@@ -98,6 +101,8 @@ Filter::Filter(filterType filt_t, int num_taps, double Fs, double Fl,
 	if( m_num_taps <= 0 || m_num_taps > MAX_NUM_FILTER_TAPS ) ECODE(-14);
 
 	m_taps = m_sr = NULL;
+	m_step_f = m_edge_delta = NULL; //SSE
+	m_edge_time = NULL; //SSE
 	m_taps = (double*)malloc( m_num_taps * sizeof(double) );
 	m_sr = (double*)malloc( m_num_taps * sizeof(double) );
 	if( m_taps == NULL || m_sr == NULL ) ECODE(-15);
@@ -106,6 +111,7 @@ Filter::Filter(filterType filt_t, int num_taps, double Fs, double Fl,
 
 	if( m_filt_t == BPF ) designBPF();
 	else ECODE(-16);
+	designSteps(); //SSE
 
 	return;
 }
@@ -114,6 +120,9 @@ Filter::~Filter()
 {
 	if( m_taps != NULL ) free( m_taps );
 	if( m_sr != NULL ) free( m_sr );
+	if( m_step_f != NULL ) free( m_step_f ); //SSE
+	if( m_edge_delta != NULL ) free( m_edge_delta ); //SSE
+	if( m_edge_time != NULL ) free( m_edge_time ); //SSE
 }
 
 void 
@@ -251,6 +260,9 @@ Filter::init()
 	if( m_error_flag != 0 ) return;
 
 	for(i = 0; i < m_num_taps; i++) m_sr[i] = 0;
+	m_edge_first = m_edge_count = 0; //SSE
+	m_now = 0;
+	m_level_in = m_level_out = 0;
 
 	return;
 }
@@ -273,3 +285,84 @@ Filter::do_sample(double data_sample)
 
 	return result;
 }
+
+
+/*  SSE: The YM2149 output is a succession of steps at 250kHz, and only one
+    sample in 5-6 is kept. The FIR output of a step of height d, m samples
+    after it, is d times the sum of taps[0..m] (band-limited step, BLEP), so
+    we only keep the steps younger than the filter and compute the output
+    when it's due: the cost depends on the number of transitions, not on the
+    input rate. Older steps are summed in m_level_out (exact, levels are
+    integers).
+    At most one step per input sample, so the ring never holds more than
+    m_num_taps steps.
+*/
+
+void 
+Filter::designSteps()
+{
+	int i, n;
+	double sum = 0;
+
+	for(n = 1; n < m_num_taps; n <<= 1);
+	m_step_f = (float*)malloc( m_num_taps * sizeof(float) );
+	m_edge_delta = (float*)malloc( n * sizeof(float) );
+	m_edge_time = (unsigned*)malloc( n * sizeof(unsigned) );
+	if( m_step_f == NULL || m_edge_delta == NULL || m_edge_time == NULL ) ECODE(-4);
+	for(i = 0; i < m_num_taps; i++){
+		sum += m_taps[i];
+		m_step_f[i] = (float)sum;
+	}
+	m_edge_mask = n - 1;
+	m_edge_first = m_edge_count = 0;
+	m_now = 0;
+	m_level_in = m_level_out = 0;
+
+	return;
+}
+
+void 
+Filter::retireSteps()
+{
+	while( m_edge_count && m_now - m_edge_time[m_edge_first] >= (unsigned)m_num_taps ){
+		m_level_out += m_edge_delta[m_edge_first];
+		m_edge_first = ( m_edge_first + 1 ) & m_edge_mask;
+		m_edge_count--;
+	}
+}
+
+void 
+Filter::set_level(float level)
+{
+	int last;
+
+	if( m_error_flag != 0 || level == m_level_in ) return;
+
+	last = ( m_edge_first + m_edge_count - 1 ) & m_edge_mask;
+	if( m_edge_count && m_edge_time[last] == m_now )
+		m_edge_delta[last] += level - m_level_in;
+	else{
+		retireSteps();
+		last = ( m_edge_first + m_edge_count ) & m_edge_mask;
+		m_edge_time[last] = m_now;
+		m_edge_delta[last] = level - m_level_in;
+		m_edge_count++;
+	}
+	m_level_in = level;
+}
+
+float 
+Filter::output()
+{
+	float result;
+	int i, j;
+
+	if( m_error_flag != 0 ) return(0);
+
+	retireSteps();
+	result = m_level_out * m_step_f[m_num_taps - 1];
+	for(i = 0, j = m_edge_first; i < m_edge_count; i++, j = ( j + 1 ) & m_edge_mask)
+		result += m_edge_delta[j] * m_step_f[m_now - m_edge_time[j]];
+
+	return result;
+}
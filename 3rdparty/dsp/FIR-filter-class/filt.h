@@ -139,6 +139,16 @@ class Filter{
 		double m_lambda;
 		double *m_taps;
 		double *m_sr;
+		// SSE: step form, for a piecewise constant input: the step response
+		// (BLEP) and the steps of the last m_num_taps samples
+		float *m_step_f;
+		float *m_edge_delta;
+		unsigned *m_edge_time;
+		int m_edge_mask, m_edge_first, m_edge_count;
+		unsigned m_now;
+		float m_level_in, m_level_out;
+		void designSteps();
+		void retireSteps();
 		void designLPF();
 		void designHPF();
 
@@ -152,6 +162,12 @@ class Filter{
 		~Filter( );
 		void init();
 		double do_sample(double data_sample);
+		// SSE: advance() by n input samples of the current level, 
+		// set_level() for the current sample, output() when an output
+		// sample is due (same response as do_sample() on every sample)
+		void advance(unsigned n) { m_now += n; }
+		void set_level(float level);
+		float output();
 		int get_error_flag(){return m_error_flag;};
 		void get_taps( double *taps );
 		int write_taps_to_file( char* filename );
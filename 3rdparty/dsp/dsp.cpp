@@ -14,6 +14,11 @@ but certainly not close to the STE.
 #include "dsp.h"
 #include <math.h>
 #include <float.h>
+#include <string.h>
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=1)
+#include <xmmintrin.h>
+#define DSP_SSE
+#endif
 
 double SampleRate=4096; // we keep this global for the moment (TODO)
 
@@ -30,7 +35,7 @@ TIirFilter::~TIirFilter() {
 
 double TIirFilter::FilterAudio(double Input,double Frequency,double Q,
                                double Gain,unsigned long Type) {
-   double Output=Input,S,omega,A,sn,cs,alpha,beta,temp1,temp2,temp3,temp4;
+   double Output=Input,omega,A,sn,cs,alpha,temp1,temp2;
 /* -- check if frequency, Q, gain or type has changed.. and, if so, 
    update coefficients */
    if ( ( Frequency != f ) || ( Q != q ) || ( Gain != g ) || ( Type != t ) ) {
@@ -83,38 +88,13 @@ double TIirFilter::FilterAudio(double Input,double Frequency,double Q,
             b1 = a1 * Gain;
             break;
          case 5:                                               /* lowshelf */
-            /* "shelf slope" 1.0 = max slope, because neither Q nor bandwidth is used in */
-            /* those filters (note: true only for lowshelf and highshelf, not peaking). */
-           
-           S = 1.0; /* used only by lowshelf and highshelf */
-            A = pow( 10.0 , ( Gain / 40.0 ) );                 /* Gain is expressed in dB */
-            omega = ( Pi2 * Frequency ) / SampleRate;
-            sn = sin( omega ); cs = cos( omega );
-            temp1 = A + 1.0; temp2 = A - 1.0; temp3 = temp1 * cs; temp4 = temp2 * cs;
-            beta = sn * sqrt( ( A * A + 1.0 ) / S - temp2 * temp2 );
-            a0 = 1.0 / ( temp1 + temp4 + beta );
-            a1 = ( -2.0 * ( temp2 + temp3 ) ) * a0;
-            a2 = ( temp1 + temp4 - beta ) * a0;
-            b0 = ( A * ( temp1 - temp4 + beta ) ) * a0;
-            b1 = ( 2.0 * A * ( temp2 - temp3 ) ) * a0;
-            b2 = ( A * ( temp1 - temp4 - beta ) ) * a0;
-            break;
          case 6:                                               /* highshelf */
-            /* "shelf slope" 1.0 = max slope, because neither Q nor bandwidth is used in */
-            /* those filters (note: true only for lowshelf and highshelf, not peaking). */
-           S = 1.0; /* used only by lowshelf and highshelf */
-            A = pow( 10.0, Gain / 40.0 ) ;                  /* Gain is expressed in dB */
-            omega = ( Pi2 * Frequency ) / SampleRate;
-            sn = sin( omega ); cs = cos( omega );
-            temp1 = A + 1.0; temp2 = A - 1.0; temp3 = temp1 * cs; temp4 = temp2 * cs;
-            beta = sn * sqrt( ( A * A + 1.0 ) / S - temp2 * temp2 );
-            a0 = 1.0 / ( temp1 - temp4 + beta );
-            a1 = ( 2.0 * ( temp2 - temp3 ) ) * a0;
-            a2 = ( temp1 - temp4 - beta ) * a0;
-            b0 = ( A * ( temp1 + temp4 + beta ) ) * a0;
-            b1 = ( -2.0 * A * ( temp2 + temp3 ) ) * a0;
-            b2 = ( A * ( temp1 + temp4 - beta ) ) * a0;
-           break;
+         {
+            double coefs[5];
+            IirShelfCoefs( Frequency, Gain, Type==6, coefs );
+            b0 = coefs[0]; b1 = coefs[1]; b2 = coefs[2]; a1 = coefs[3]; a2 = coefs[4];
+            break;
+         }
          case 7:                                               /* peaking */
             A = pow( 10.0, ( Gain / 40.0 ) );                  /* Gain is expressed in dB */
             omega = ( Pi2 * Frequency ) / SampleRate;
@@ -178,6 +158,120 @@ double TIirLowShelf::FilterAudio(double Input,double Frequency,double Gain) {
 }
 
 
+void IirShelfCoefs(double Frequency,double Gain,bool High,double Coefs[5]) {
+/*  Coefficients b0, b1, b2, a1, a2 (normalised by a0) of the low or high
+    shelf, as in TIirFilter::FilterAudio().
+    "shelf slope" 1.0 = max slope, because neither Q nor bandwidth is used in
+    those filters (note: true only for lowshelf and highshelf, not peaking).
+*/
+  double S,omega,A,sn,cs,beta,temp1,temp2,temp3,temp4,a0;
+  S = 1.0; /* used only by lowshelf and highshelf */
+  A = pow( 10.0 , ( Gain / 40.0 ) );                 /* Gain is expressed in dB */
+  omega = ( Pi2 * Frequency ) / SampleRate;
+  sn = sin( omega ); cs = cos( omega );
+  temp1 = A + 1.0; temp2 = A - 1.0; temp3 = temp1 * cs; temp4 = temp2 * cs;
+  beta = sn * sqrt( ( A * A + 1.0 ) / S - temp2 * temp2 );
+  if(High)
+  {
+    a0 = 1.0 / ( temp1 - temp4 + beta );
+    Coefs[3] = ( 2.0 * ( temp2 - temp3 ) ) * a0;
+    Coefs[4] = ( temp1 - temp4 - beta ) * a0;
+    Coefs[0] = ( A * ( temp1 + temp4 + beta ) ) * a0;
+    Coefs[1] = ( -2.0 * A * ( temp2 + temp3 ) ) * a0;
+    Coefs[2] = ( A * ( temp1 + temp4 - beta ) ) * a0;
+  }
+  else
+  {
+    a0 = 1.0 / ( temp1 + temp4 + beta );
+    Coefs[3] = ( -2.0 * ( temp2 + temp3 ) ) * a0;
+    Coefs[4] = ( temp1 + temp4 - beta ) * a0;
+    Coefs[0] = ( A * ( temp1 - temp4 + beta ) ) * a0;
+    Coefs[1] = ( 2.0 * A * ( temp2 - temp3 ) ) * a0;
+    Coefs[2] = ( A * ( temp1 - temp4 - beta ) ) * a0;
+  }
+}
+
+
+void TIirTone::SetTone(double BassFrequency,double BassGain,
+                       double TrebleFrequency,double TrebleGain) {
+  double coefs[2][5]={{1,0,0,0,0},{1,0,0,0,0}}; // neutral: pass through
+  if(BassGain!=0)
+    IirShelfCoefs(BassFrequency,BassGain,false,coefs[0]);
+  if(TrebleGain!=0)
+    IirShelfCoefs(TrebleFrequency,TrebleGain,true,coefs[1]);
+  for(int lane=0;lane<4;lane++)
+  {
+    double *c=coefs[lane>>1];
+    b0[lane]=(float)c[0];
+    b1[lane]=(float)c[1];
+    b2[lane]=(float)c[2];
+    a1[lane]=(float)-c[3];
+    a2[lane]=(float)-c[4];
+  }
+}
+
+
+void TIirTone::ResetState() {
+  memset(i1,0,sizeof(i1));
+  memset(i2,0,sizeof(i2));
+  memset(o1,0,sizeof(o1));
+  memset(o2,0,sizeof(o2));
+}
+
+
+void TIirTone::Process(int *Frames,int Count,float GainL,float GainR) {
+/*  Frames are interleaved L,R, processed in place. The bass output of the
+    previous frame (o1 lanes 0-1) is the input of the treble lanes.
+*/
+#if defined(DSP_SSE)
+  __m128 vb0=_mm_loadu_ps(b0),vb1=_mm_loadu_ps(b1),vb2=_mm_loadu_ps(b2);
+  __m128 va1=_mm_loadu_ps(a1),va2=_mm_loadu_ps(a2);
+  __m128 vi1=_mm_loadu_ps(i1),vi2=_mm_loadu_ps(i2);
+  __m128 vo1=_mm_loadu_ps(o1),vo2=_mm_loadu_ps(o2);
+  __m128 gain=_mm_setr_ps(0,0,GainL,GainR);
+  for(int i=0;i<Count;i++,Frames+=2)
+  {
+    __m128 x=_mm_movelh_ps(_mm_setr_ps((float)Frames[0],(float)Frames[1],0,0),
+      vo1);
+    __m128 y=_mm_add_ps(_mm_add_ps(_mm_mul_ps(vb0,x),_mm_mul_ps(vb1,vi1)),
+      _mm_add_ps(_mm_mul_ps(vb2,vi2),
+      _mm_add_ps(_mm_mul_ps(va1,vo1),_mm_mul_ps(va2,vo2))));
+    vi2=vi1;
+    vi1=x;
+    vo2=vo1;
+    vo1=y;
+    y=_mm_mul_ps(y,gain);
+    Frames[0]=_mm_cvtt_ss2si(_mm_movehl_ps(y,y));
+    Frames[1]=_mm_cvtt_ss2si(_mm_shuffle_ps(y,y,_MM_SHUFFLE(3,3,3,3)));
+  }
+  _mm_storeu_ps(i1,vi1);
+  _mm_storeu_ps(i2,vi2);
+  _mm_storeu_ps(o1,vo1);
+  _mm_storeu_ps(o2,vo2);
+#else
+  float x[4],y[4];
+  for(int i=0;i<Count;i++,Frames+=2)
+  {
+    x[0]=(float)Frames[0];
+    x[1]=(float)Frames[1];
+    x[2]=o1[0];
+    x[3]=o1[1];
+    for(int lane=0;lane<4;lane++)
+    {
+      y[lane]=b0[lane]*x[lane]+b1[lane]*i1[lane]+b2[lane]*i2[lane]
+        +a1[lane]*o1[lane]+a2[lane]*o2[lane];
+      i2[lane]=i1[lane];
+      i1[lane]=x[lane];
+      o2[lane]=o1[lane];
+      o1[lane]=y[lane];
+    }
+    Frames[0]=(int)(y[2]*GainL);
+    Frames[1]=(int)(y[3]*GainR);
+  }
+#endif
+}
+
+
 double old_gain=0;
 
 double TIirVolume::FilterAudio(double Input,double Gain) {
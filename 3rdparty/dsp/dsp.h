@@ -54,4 +54,27 @@ public:
   double FilterAudio(double Input,double Gain);
 };
 
+
+/*  Tone stage (bass and treble shelves) for both channels of a stereo stream,
+    in float, by blocks. The two biquads run in the same SSE register: lanes
+    0-1 are the bass filter (L,R) for frame n, lanes 2-3 the treble filter
+    for the output of the bass filter at frame n-1, so the stage has a latency
+    of 1 sample. A neutral shelf (gain 0) passes samples through.
+    SetTone() computes coefficients, the caller only calls it when they
+    change.
+*/
+
+class TIirTone {
+public:
+  void SetTone(double BassFrequency,double BassGain,double TrebleFrequency,
+    double TrebleGain);
+  void Process(int *Frames,int Count,float GainL,float GainR);
+  void ResetState();
+protected:
+  float b0[4],b1[4],b2[4],a1[4],a2[4]; // a1, a2 negated
+  float i1[4],i2[4],o1[4],o2[4];
+};
+
+void IirShelfCoefs(double Frequency,double Gain,bool High,double Coefs[5]);
+
 #endif//#ifndef DSP_H
\ No newline at end of file
@@ -67,7 +67,7 @@ Objects0=$(IntermediateDirectory)/steem_acia.cpp$(ObjectSuffix) $(IntermediateDi
 	$(IntermediateDirectory)/steem_interface_caps.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_interface_stvl.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_iolist.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_ior.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_iow.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_key_table.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_loadsave.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_loadsave_emu.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_macros.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_main.cpp$(ObjectSuffix) \
 	$(IntermediateDirectory)/steem_mem_browser.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_mfp.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_midi.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_mmu.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_mr_static.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_notifyinit.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_options.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_options_create.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_osd.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_palette.cpp$(ObjectSuffix) \
 	$(IntermediateDirectory)/steem_patchesbox.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_psg.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_reset.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_rs232.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_run.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_screen_saver.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_shifter.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_shortcutbox.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_sound.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_Steem.cpp$(ObjectSuffix) \
-	$(IntermediateDirectory)/steem_steemintro.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_stemdialogs.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_stemwin.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_stjoy.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_stports.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_translate.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_diskman_diags.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_interface_pa.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_interface_rta.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_tos.cpp$(ObjectSuffix) \
+	$(IntermediateDirectory)/steem_steemintro.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_stemdialogs.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_stemwin.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_stjoy.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_stports.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_translate.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_diskman_diags.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_interface_pa.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_interface_rta.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_tos.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_thread.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_sound_record.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_flac.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_benchmark.cpp$(ObjectSuffix) $(IntermediateDirectory)/steem_draw_threads.cpp$(ObjectSuffix) \
 	
 
 Objects1=$(IntermediateDirectory)/asm_asm_draw.asm$(ObjectSuffix) $(IntermediateDirectory)/asm_asm_osd_draw.asm$(ObjectSuffix) $(IntermediateDirectory)/rc_resource.asm$(ObjectSuffix) $(IntermediateDirectory)/include_circularbuffer.cpp$(ObjectSuffix) $(IntermediateDirectory)/include_configstorefile.cpp$(ObjectSuffix) $(IntermediateDirectory)/include_di_get_contents.cpp$(ObjectSuffix) $(IntermediateDirectory)/include_dynamicarray.cpp$(ObjectSuffix) $(IntermediateDirectory)/include_easycompress.cpp$(ObjectSuffix) $(IntermediateDirectory)/include_easystr.cpp$(ObjectSuffix) $(IntermediateDirectory)/include_easystringlist.cpp$(ObjectSuffix) \
@@ -749,6 +749,46 @@ $(IntermediateDirectory)/steem_tos.cpp$(DependSuffix): ../steem/tos.cpp
 $(IntermediateDirectory)/steem_tos.cpp$(PreprocessSuffix): ../steem/tos.cpp
 	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/steem_tos.cpp$(PreprocessSuffix) "../steem/tos.cpp"
 
+$(IntermediateDirectory)/steem_thread.cpp$(ObjectSuffix): ../steem/thread.cpp $(IntermediateDirectory)/steem_thread.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/home/user/Documents/ST/steem/thread.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/steem_thread.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/steem_thread.cpp$(DependSuffix): ../steem/thread.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/steem_thread.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/steem_thread.cpp$(DependSuffix) -MM "../steem/thread.cpp"
+
+$(IntermediateDirectory)/steem_thread.cpp$(PreprocessSuffix): ../steem/thread.cpp
+	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/steem_thread.cpp$(PreprocessSuffix) "../steem/thread.cpp"
+
+$(IntermediateDirectory)/steem_sound_record.cpp$(ObjectSuffix): ../steem/sound_record.cpp $(IntermediateDirectory)/steem_sound_record.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/home/user/Documents/ST/steem/sound_record.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/steem_sound_record.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/steem_sound_record.cpp$(DependSuffix): ../steem/sound_record.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/steem_sound_record.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/steem_sound_record.cpp$(DependSuffix) -MM "../steem/sound_record.cpp"
+
+$(IntermediateDirectory)/steem_sound_record.cpp$(PreprocessSuffix): ../steem/sound_record.cpp
+	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/steem_sound_record.cpp$(PreprocessSuffix) "../steem/sound_record.cpp"
+
+$(IntermediateDirectory)/steem_flac.cpp$(ObjectSuffix): ../steem/flac.cpp $(IntermediateDirectory)/steem_flac.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/home/user/Documents/ST/steem/flac.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/steem_flac.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/steem_flac.cpp$(DependSuffix): ../steem/flac.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/steem_flac.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/steem_flac.cpp$(DependSuffix) -MM "../steem/flac.cpp"
+
+$(IntermediateDirectory)/steem_flac.cpp$(PreprocessSuffix): ../steem/flac.cpp
+	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/steem_flac.cpp$(PreprocessSuffix) "../steem/flac.cpp"
+
+$(IntermediateDirectory)/steem_benchmark.cpp$(ObjectSuffix): ../steem/benchmark.cpp $(IntermediateDirectory)/steem_benchmark.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/home/user/Documents/ST/steem/benchmark.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/steem_benchmark.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/steem_benchmark.cpp$(DependSuffix): ../steem/benchmark.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/steem_benchmark.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/steem_benchmark.cpp$(DependSuffix) -MM "../steem/benchmark.cpp"
+
+$(IntermediateDirectory)/steem_benchmark.cpp$(PreprocessSuffix): ../steem/benchmark.cpp
+	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/steem_benchmark.cpp$(PreprocessSuffix) "../steem/benchmark.cpp"
+
+$(IntermediateDirectory)/steem_draw_threads.cpp$(ObjectSuffix): ../steem/draw_threads.cpp $(IntermediateDirectory)/steem_draw_threads.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/home/user/Documents/ST/steem/draw_threads.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/steem_draw_threads.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/steem_draw_threads.cpp$(DependSuffix): ../steem/draw_threads.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/steem_draw_threads.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/steem_draw_threads.cpp$(DependSuffix) -MM "../steem/draw_threads.cpp"
+
+$(IntermediateDirectory)/steem_draw_threads.cpp$(PreprocessSuffix): ../steem/draw_threads.cpp
+	$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/steem_draw_threads.cpp$(PreprocessSuffix) "../steem/draw_threads.cpp"
+
 $(IntermediateDirectory)/asm_asm_draw.asm$(ObjectSuffix): ../steem/asm/asm_draw.asm $(IntermediateDirectory)/asm_asm_draw.asm$(DependSuffix)
 	$(AS) -felf "/home/user/Documents/ST/steem/asm/asm_draw.asm" $(ASFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/asm_asm_draw.asm$(ObjectSuffix) -I$(IncludePath)
 $(IntermediateDirectory)/asm_asm_draw.asm$(DependSuffix): ../steem/asm/asm_draw.asm
@@ -82,6 +82,12 @@ void crtemu_coordinates_bitmap_to_window( crtemu_t* crtemu, int width, int heigh
     #define CRTEMU_SDL
 #endif
 
+// Number of pixel unpack buffers the frames are streamed through, 0 uploads
+// straight from the caller's pixels.
+#ifndef CRTEMU_PBO_COUNT
+    #define CRTEMU_PBO_COUNT 2
+#endif
+
 
 #ifndef CRTEMU_SDL
 
@@ -144,6 +150,9 @@ void crtemu_coordinates_bitmap_to_window( crtemu_t* crtemu, int width, int heigh
     #define CRTEMU_GL_TEXTURE_WRAP_T 0x2803
     #define CRTEMU_GL_CLAMP_TO_BORDER 0x812D
     #define CRTEMU_GL_TEXTURE_BORDER_COLOR 0x1004
+    #define CRTEMU_GL_PIXEL_UNPACK_BUFFER 0x88ec
+    #define CRTEMU_GL_STREAM_DRAW 0x88e0
+    #define CRTEMU_GL_WRITE_ONLY 0x88b9
 
 #else
 
@@ -191,6 +200,9 @@ void crtemu_coordinates_bitmap_to_window( crtemu_t* crtemu, int width, int heigh
      #define CRTEMU_GL_TEXTURE_WRAP_T GL_TEXTURE_WRAP_T 
      #define CRTEMU_GL_CLAMP_TO_BORDER GL_CLAMP_TO_BORDER 
      #define CRTEMU_GL_TEXTURE_BORDER_COLOR GL_TEXTURE_BORDER_COLOR
+     #define CRTEMU_GL_PIXEL_UNPACK_BUFFER GL_PIXEL_UNPACK_BUFFER
+     #define CRTEMU_GL_STREAM_DRAW GL_STREAM_DRAW
+     #define CRTEMU_GL_WRITE_ONLY GL_WRITE_ONLY
 #endif
 
 
@@ -224,6 +236,20 @@ struct crtemu_t
     int last_present_width;
     int last_present_height;
 
+    #if CRTEMU_PBO_COUNT > 0
+        CRTEMU_GLuint unpackbuffers[ CRTEMU_PBO_COUNT ]; // all 0 if MapBuffer isn't available
+        int unpackbuffer_index;
+    #endif
+
+    // Uniform locations, looked up once in crtemu_create
+    struct { CRTEMU_GLint blur; } blur_loc;
+    struct { CRTEMU_GLint modulate; } accumulate_loc, blend_loc;
+    struct 
+        { 
+        CRTEMU_GLint use_frame, time, resolution, modulate, cfg_curvature, cfg_scanlines, cfg_shadow_mask, cfg_separation, 
+            cfg_ghosting, cfg_noise, cfg_flicker, cfg_vignette, cfg_distortion, cfg_aspect_lock, cfg_hpos, cfg_vpos, 
+            cfg_hsize, cfg_vsize, cfg_contrast, cfg_brightness, cfg_saturation, cfg_degauss; 
+        } crt_loc;
 
     #ifndef CRTEMU_SDL
         struct HINSTANCE__* gl_dll;
@@ -264,6 +290,9 @@ struct crtemu_t
     void (CRTEMU_GLCALLTYPE* Uniform3f) (CRTEMU_GLint location, CRTEMU_GLfloat v0, CRTEMU_GLfloat v1, CRTEMU_GLfloat v2);
     CRTEMU_GLint (CRTEMU_GLCALLTYPE* GetUniformLocation) (CRTEMU_GLuint program, CRTEMU_GLchar const* name);
     void (CRTEMU_GLCALLTYPE* TexImage2D) (CRTEMU_GLenum target, CRTEMU_GLint level, CRTEMU_GLint internalformat, CRTEMU_GLsizei width, CRTEMU_GLsizei height, CRTEMU_GLint border, CRTEMU_GLenum format, CRTEMU_GLenum type, void const* pixels);
+    void (CRTEMU_GLCALLTYPE* TexSubImage2D) (CRTEMU_GLenum target, CRTEMU_GLint level, CRTEMU_GLint xoffset, CRTEMU_GLint yoffset, CRTEMU_GLsizei width, CRTEMU_GLsizei height, CRTEMU_GLenum format, CRTEMU_GLenum type, void const* pixels);
+    void* (CRTEMU_GLCALLTYPE* MapBuffer) (CRTEMU_GLenum target, CRTEMU_GLenum access); // optional
+    CRTEMU_GLboolean (CRTEMU_GLCALLTYPE* UnmapBuffer) (CRTEMU_GLenum target); // optional
     void (CRTEMU_GLCALLTYPE* ClearColor) (CRTEMU_GLfloat red, CRTEMU_GLfloat green, CRTEMU_GLfloat blue, CRTEMU_GLfloat alpha);
     void (CRTEMU_GLCALLTYPE* Clear) (CRTEMU_GLbitfield mask);
     void (CRTEMU_GLCALLTYPE* DrawArrays) (CRTEMU_GLenum mode, CRTEMU_GLint first, CRTEMU_GLsizei count);
@@ -421,6 +450,9 @@ crtemu_t* crtemu_create( void* memctx )
         crtemu->Uniform3f = ( void (CRTEMU_GLCALLTYPE*) (CRTEMU_GLint, CRTEMU_GLfloat, CRTEMU_GLfloat, CRTEMU_GLfloat) ) (uintptr_t) GetProcAddress( crtemu->gl_dll, "glUniform3f" );
         crtemu->GetUniformLocation = ( CRTEMU_GLint (CRTEMU_GLCALLTYPE*) (CRTEMU_GLuint, CRTEMU_GLchar const*) ) (uintptr_t) GetProcAddress( crtemu->gl_dll, "glGetUniformLocation" );
         crtemu->TexImage2D = ( void (CRTEMU_GLCALLTYPE*) (CRTEMU_GLenum, CRTEMU_GLint, CRTEMU_GLint, CRTEMU_GLsizei, CRTEMU_GLsizei, CRTEMU_GLint, CRTEMU_GLenum, CRTEMU_GLenum, void const*) ) (uintptr_t) GetProcAddress( crtemu->gl_dll, "glTexImage2D" );
+        crtemu->TexSubImage2D = ( void (CRTEMU_GLCALLTYPE*) (CRTEMU_GLenum, CRTEMU_GLint, CRTEMU_GLint, CRTEMU_GLint, CRTEMU_GLsizei, CRTEMU_GLsizei, CRTEMU_GLenum, CRTEMU_GLenum, void const*) ) (uintptr_t) GetProcAddress( crtemu->gl_dll, "glTexSubImage2D" );
+        crtemu->MapBuffer = ( void* (CRTEMU_GLCALLTYPE*) (CRTEMU_GLenum, CRTEMU_GLenum) ) (uintptr_t) GetProcAddress( crtemu->gl_dll, "glMapBuffer" );
+        crtemu->UnmapBuffer = ( CRTEMU_GLboolean (CRTEMU_GLCALLTYPE*) (CRTEMU_GLenum) ) (uintptr_t) GetProcAddress( crtemu->gl_dll, "glUnmapBuffer" );
         crtemu->ClearColor = ( void (CRTEMU_GLCALLTYPE*) (CRTEMU_GLfloat, CRTEMU_GLfloat, CRTEMU_GLfloat, CRTEMU_GLfloat) ) (uintptr_t) GetProcAddress( crtemu->gl_dll, "glClearColor" );
         crtemu->Clear = ( void (CRTEMU_GLCALLTYPE*) (CRTEMU_GLbitfield) ) (uintptr_t) GetProcAddress( crtemu->gl_dll, "glClear" );
         crtemu->DrawArrays = ( void (CRTEMU_GLCALLTYPE*) (CRTEMU_GLenum, CRTEMU_GLint, CRTEMU_GLsizei) ) (uintptr_t) GetProcAddress( crtemu->gl_dll, "glDrawArrays" );
@@ -466,6 +498,9 @@ crtemu_t* crtemu_create( void* memctx )
         if( !crtemu->Uniform3f ) crtemu->Uniform3f = ( void (CRTEMU_GLCALLTYPE*) (CRTEMU_GLint, CRTEMU_GLfloat, CRTEMU_GLfloat, CRTEMU_GLfloat) ) (uintptr_t) crtemu->wglGetProcAddress( "glUniform3f" );
         if( !crtemu->GetUniformLocation ) crtemu->GetUniformLocation = ( CRTEMU_GLint (CRTEMU_GLCALLTYPE*) (CRTEMU_GLuint, CRTEMU_GLchar const*) ) (uintptr_t) crtemu->wglGetProcAddress( "glGetUniformLocation" );
         if( !crtemu->TexImage2D ) crtemu->TexImage2D = ( void (CRTEMU_GLCALLTYPE*) (CRTEMU_GLenum, CRTEMU_GLint, CRTEMU_GLint, CRTEMU_GLsizei, CRTEMU_GLsizei, CRTEMU_GLint, CRTEMU_GLenum, CRTEMU_GLenum, void const*) ) (uintptr_t) crtemu->wglGetProcAddress( "glTexImage2D" );
+        if( !crtemu->TexSubImage2D ) crtemu->TexSubImage2D = ( void (CRTEMU_GLCALLTYPE*) (CRTEMU_GLenum, CRTEMU_GLint, CRTEMU_GLint, CRTEMU_GLint, CRTEMU_GLsizei, CRTEMU_GLsizei, CRTEMU_GLenum, CRTEMU_GLenum, void const*) ) (uintptr_t) crtemu->wglGetProcAddress( "glTexSubImage2D" );
+        if( !crtemu->MapBuffer ) crtemu->MapBuffer = ( void* (CRTEMU_GLCALLTYPE*) (CRTEMU_GLenum, CRTEMU_GLenum) ) (uintptr_t) crtemu->wglGetProcAddress( "glMapBuffer" );
+        if( !crtemu->UnmapBuffer ) crtemu->UnmapBuffer = ( CRTEMU_GLboolean (CRTEMU_GLCALLTYPE*) (CRTEMU_GLenum) ) (uintptr_t) crtemu->wglGetProcAddress( "glUnmapBuffer" );
         if( !crtemu->ClearColor ) crtemu->ClearColor = ( void (CRTEMU_GLCALLTYPE*) (CRTEMU_GLfloat, CRTEMU_GLfloat, CRTEMU_GLfloat, CRTEMU_GLfloat) ) (uintptr_t) crtemu->wglGetProcAddress( "glClearColor" );
         if( !crtemu->Clear ) crtemu->Clear = ( void (CRTEMU_GLCALLTYPE*) (CRTEMU_GLbitfield) ) (uintptr_t) crtemu->wglGetProcAddress( "glClear" );
         if( !crtemu->DrawArrays ) crtemu->DrawArrays = ( void (CRTEMU_GLCALLTYPE*) (CRTEMU_GLenum, CRTEMU_GLint, CRTEMU_GLsizei) ) (uintptr_t) crtemu->wglGetProcAddress( "glDrawArrays" );
@@ -512,6 +547,9 @@ crtemu_t* crtemu_create( void* memctx )
          crtemu->Uniform3f = glUniform3f;
          crtemu->GetUniformLocation = glGetUniformLocation;
          crtemu->TexImage2D = glTexImage2D;
+         crtemu->TexSubImage2D = glTexSubImage2D;
+         crtemu->MapBuffer = glMapBuffer;
+         crtemu->UnmapBuffer = glUnmapBuffer;
          crtemu->ClearColor = glClearColor;
          crtemu->Clear = glClear;
          crtemu->DrawArrays = glDrawArrays;
@@ -559,6 +597,7 @@ crtemu_t* crtemu_create( void* memctx )
     if( !crtemu->Uniform3f ) goto failed;
     if( !crtemu->GetUniformLocation ) goto failed;
     if( !crtemu->TexImage2D ) goto failed;
+    if( !crtemu->TexSubImage2D ) goto failed;
     if( !crtemu->ClearColor ) goto failed;
     if( !crtemu->Clear ) goto failed;
     if( !crtemu->DrawArrays ) goto failed;
@@ -844,6 +883,61 @@ crtemu_t* crtemu_create( void* memctx )
     crtemu->EnableVertexAttribArray( 0 );
     crtemu->VertexAttribPointer( 0, 4, CRTEMU_GL_FLOAT, CRTEMU_GL_FALSE, 4 * sizeof( CRTEMU_GLfloat ), 0 );
 
+    #if CRTEMU_PBO_COUNT > 0
+        if( crtemu->MapBuffer && crtemu->UnmapBuffer ) 
+            crtemu->GenBuffers( CRTEMU_PBO_COUNT, crtemu->unpackbuffers );
+        crtemu->unpackbuffer_index = 0;
+    #endif
+
+    // The samplers never change unit, they're set once. Other uniforms are
+    // set each frame, by location.
+    crtemu->UseProgram( crtemu->blur_shader );
+    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->blur_shader, "texture" ), 0 );
+    crtemu->blur_loc.blur = crtemu->GetUniformLocation( crtemu->blur_shader, "blur" );
+
+    crtemu->UseProgram( crtemu->accumulate_shader );
+    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->accumulate_shader, "tex0" ), 0 );
+    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->accumulate_shader, "tex1" ), 1 );
+    crtemu->accumulate_loc.modulate = crtemu->GetUniformLocation( crtemu->accumulate_shader, "modulate" );
+
+    crtemu->UseProgram( crtemu->blend_shader );
+    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->blend_shader, "tex0" ), 0 );
+    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->blend_shader, "tex1" ), 1 );
+    crtemu->blend_loc.modulate = crtemu->GetUniformLocation( crtemu->blend_shader, "modulate" );
+
+    crtemu->UseProgram( crtemu->copy_shader );
+    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->copy_shader, "tex0" ), 0 );
+
+    crtemu->UseProgram( crtemu->crt_shader );
+    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->crt_shader, "backbuffer" ), 0 );
+    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->crt_shader, "blurbuffer" ), 1 );
+    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->crt_shader, "frametexture" ), 2 );
+    #define CRTEMU_CRT_LOC( name ) crtemu->crt_loc.name = crtemu->GetUniformLocation( crtemu->crt_shader, #name )
+    CRTEMU_CRT_LOC( use_frame );
+    CRTEMU_CRT_LOC( time );
+    CRTEMU_CRT_LOC( resolution );
+    CRTEMU_CRT_LOC( modulate );
+    CRTEMU_CRT_LOC( cfg_curvature );
+    CRTEMU_CRT_LOC( cfg_scanlines );
+    CRTEMU_CRT_LOC( cfg_shadow_mask );
+    CRTEMU_CRT_LOC( cfg_separation );
+    CRTEMU_CRT_LOC( cfg_ghosting );
+    CRTEMU_CRT_LOC( cfg_noise );
+    CRTEMU_CRT_LOC( cfg_flicker );
+    CRTEMU_CRT_LOC( cfg_vignette );
+    CRTEMU_CRT_LOC( cfg_distortion );
+    CRTEMU_CRT_LOC( cfg_aspect_lock );
+    CRTEMU_CRT_LOC( cfg_hpos );
+    CRTEMU_CRT_LOC( cfg_vpos );
+    CRTEMU_CRT_LOC( cfg_hsize );
+    CRTEMU_CRT_LOC( cfg_vsize );
+    CRTEMU_CRT_LOC( cfg_contrast );
+    CRTEMU_CRT_LOC( cfg_brightness );
+    CRTEMU_CRT_LOC( cfg_saturation );
+    CRTEMU_CRT_LOC( cfg_degauss );
+    #undef CRTEMU_CRT_LOC
+    crtemu->UseProgram( 0 );
+
     return crtemu;
 
 failed:
@@ -880,6 +974,9 @@ void crtemu_destroy( crtemu_t* crtemu )
     crtemu->DeleteTextures( 1, &crtemu->frametexture ); 
     crtemu->DeleteTextures( 1, &crtemu->backbuffer ); 
     crtemu->DeleteBuffers( 1, &crtemu->vertexbuffer );
+    #if CRTEMU_PBO_COUNT > 0
+        if( crtemu->unpackbuffers[ 0 ] ) crtemu->DeleteBuffers( CRTEMU_PBO_COUNT, crtemu->unpackbuffers );
+    #endif
     #ifndef CRTEMU_SDL
         FreeLibrary( crtemu->gl_dll );
     #endif
@@ -910,8 +1007,7 @@ static void crtemu_internal_blur( crtemu_t* crtemu, CRTEMU_GLuint source, CRTEMU
     {
     crtemu->BindFramebuffer( CRTEMU_GL_FRAMEBUFFER, blurbuffer_b );
     crtemu->UseProgram( crtemu->blur_shader );
-    crtemu->Uniform2f( crtemu->GetUniformLocation( crtemu->blur_shader, "blur" ), r / (float) width, 0 );
-    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->blur_shader, "texture" ), 0 );
+    crtemu->Uniform2f( crtemu->blur_loc.blur, r / (float) width, 0 );
     crtemu->ActiveTexture( CRTEMU_GL_TEXTURE0 );
     crtemu->BindTexture( CRTEMU_GL_TEXTURE_2D, source );
     crtemu->TexParameteri( CRTEMU_GL_TEXTURE_2D, CRTEMU_GL_TEXTURE_MIN_FILTER, CRTEMU_GL_LINEAR );
@@ -923,8 +1019,7 @@ static void crtemu_internal_blur( crtemu_t* crtemu, CRTEMU_GLuint source, CRTEMU
 
     crtemu->BindFramebuffer( CRTEMU_GL_FRAMEBUFFER, blurbuffer_a );
     crtemu->UseProgram( crtemu->blur_shader );
-    crtemu->Uniform2f( crtemu->GetUniformLocation( crtemu->blur_shader, "blur" ), 0, r / (float) height );
-    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->blur_shader, "texture" ), 0 );
+    crtemu->Uniform2f( crtemu->blur_loc.blur, 0, r / (float) height );
     crtemu->ActiveTexture( CRTEMU_GL_TEXTURE0 );
     crtemu->BindTexture( CRTEMU_GL_TEXTURE_2D, blurtexture_b );
     crtemu->TexParameteri( CRTEMU_GL_TEXTURE_2D, CRTEMU_GL_TEXTURE_MIN_FILTER, CRTEMU_GL_LINEAR );
@@ -969,6 +1064,11 @@ void crtemu_present( crtemu_t* crtemu, CRTEMU_U64 time_us, CRTEMU_U32 const* pix
         crtemu->BindFramebuffer( CRTEMU_GL_FRAMEBUFFER, crtemu->blurbuffer_b );
         crtemu->FramebufferTexture2D( CRTEMU_GL_FRAMEBUFFER, CRTEMU_GL_COLOR_ATTACHMENT0, CRTEMU_GL_TEXTURE_2D, crtemu->blurtexture_b, 0 );
         crtemu->BindFramebuffer( CRTEMU_GL_FRAMEBUFFER, 0 );
+
+        // Backbuffer storage, frames are then uploaded into it with TexSubImage2D
+        crtemu->BindTexture( CRTEMU_GL_TEXTURE_2D, crtemu->backbuffer );
+        crtemu->TexImage2D( CRTEMU_GL_TEXTURE_2D, 0, CRTEMU_GL_RGBA, width, height, 0, CRTEMU_GL_RGBA, CRTEMU_GL_UNSIGNED_BYTE, 0 ); 
+        crtemu->BindTexture( CRTEMU_GL_TEXTURE_2D, 0 );
         }
 
     
@@ -988,7 +1088,31 @@ void crtemu_present( crtemu_t* crtemu, CRTEMU_U64 time_us, CRTEMU_U32 const* pix
     // Copy to backbuffer
     crtemu->ActiveTexture( CRTEMU_GL_TEXTURE0 );
     crtemu->BindTexture( CRTEMU_GL_TEXTURE_2D, crtemu->backbuffer );
-    crtemu->TexImage2D( CRTEMU_GL_TEXTURE_2D, 0, CRTEMU_GL_RGBA, width, height, 0, CRTEMU_GL_RGBA, CRTEMU_GL_UNSIGNED_BYTE, pixels_xbgr ); 
+    int uploaded = 0;
+    #if CRTEMU_PBO_COUNT > 0
+        if( crtemu->unpackbuffers[ 0 ] ) 
+            {
+            // Orphan the next buffer of the ring so the driver doesn't wait for a pending transfer, 
+            // the texture is then updated from it asynchronously
+            CRTEMU_GLsizeiptr size = (CRTEMU_GLsizeiptr) width * height * sizeof( CRTEMU_U32 );
+            crtemu->BindBuffer( CRTEMU_GL_PIXEL_UNPACK_BUFFER, crtemu->unpackbuffers[ crtemu->unpackbuffer_index ] );
+            crtemu->unpackbuffer_index = ( crtemu->unpackbuffer_index + 1 ) % CRTEMU_PBO_COUNT;
+            crtemu->BufferData( CRTEMU_GL_PIXEL_UNPACK_BUFFER, size, 0, CRTEMU_GL_STREAM_DRAW );
+            void* mapped = size ? crtemu->MapBuffer( CRTEMU_GL_PIXEL_UNPACK_BUFFER, CRTEMU_GL_WRITE_ONLY ) : 0;
+            if( mapped ) 
+                {
+                memcpy( mapped, pixels_xbgr, size );
+                if( crtemu->UnmapBuffer( CRTEMU_GL_PIXEL_UNPACK_BUFFER ) )
+                    {
+                    crtemu->TexSubImage2D( CRTEMU_GL_TEXTURE_2D, 0, 0, 0, width, height, CRTEMU_GL_RGBA, CRTEMU_GL_UNSIGNED_BYTE, 0 ); 
+                    uploaded = 1;
+                    }
+                }
+            crtemu->BindBuffer( CRTEMU_GL_PIXEL_UNPACK_BUFFER, 0 );
+            }
+    #endif
+    if( !uploaded )
+        crtemu->TexSubImage2D( CRTEMU_GL_TEXTURE_2D, 0, 0, 0, width, height, CRTEMU_GL_RGBA, CRTEMU_GL_UNSIGNED_BYTE, pixels_xbgr ); 
     crtemu->BindTexture( CRTEMU_GL_TEXTURE_2D, 0 );
 
     crtemu->Viewport( 0, 0, width, height );
@@ -999,9 +1123,7 @@ void crtemu_present( crtemu_t* crtemu, CRTEMU_U64 time_us, CRTEMU_U32 const* pix
     // Update accumulation buffer
     crtemu->BindFramebuffer( CRTEMU_GL_FRAMEBUFFER, crtemu->accumulatebuffer_a );
     crtemu->UseProgram( crtemu->accumulate_shader );
-    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->accumulate_shader, "tex0" ), 0 );
-    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->accumulate_shader, "tex1" ), 1 );
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->accumulate_shader, "modulate" ), 1.0f );
+    crtemu->Uniform1f( crtemu->accumulate_loc.modulate, 1.0f );
     crtemu->ActiveTexture( CRTEMU_GL_TEXTURE0 );
     crtemu->BindTexture( CRTEMU_GL_TEXTURE_2D, crtemu->backbuffer );   
     crtemu->TexParameteri( CRTEMU_GL_TEXTURE_2D, CRTEMU_GL_TEXTURE_MIN_FILTER, CRTEMU_GL_LINEAR );
@@ -1021,7 +1143,6 @@ void crtemu_present( crtemu_t* crtemu, CRTEMU_U64 time_us, CRTEMU_U32 const* pix
     // Store a copy of the accumulation buffer
     crtemu->BindFramebuffer( CRTEMU_GL_FRAMEBUFFER, crtemu->accumulatebuffer_b );
     crtemu->UseProgram( crtemu->copy_shader );
-    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->copy_shader, "tex0" ), 0 );
     crtemu->ActiveTexture( CRTEMU_GL_TEXTURE0 );
     crtemu->BindTexture( CRTEMU_GL_TEXTURE_2D, crtemu->accumulatetexture_a );   
     crtemu->TexParameteri( CRTEMU_GL_TEXTURE_2D, CRTEMU_GL_TEXTURE_MIN_FILTER, CRTEMU_GL_LINEAR );
@@ -1034,9 +1155,7 @@ void crtemu_present( crtemu_t* crtemu, CRTEMU_U64 time_us, CRTEMU_U32 const* pix
     // Blend accumulation and backbuffer
     crtemu->BindFramebuffer( CRTEMU_GL_FRAMEBUFFER, crtemu->accumulatebuffer_a );
     crtemu->UseProgram( crtemu->blend_shader );
-    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->blend_shader, "tex0" ), 0 );
-    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->blend_shader, "tex1" ), 1 );
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->blend_shader, "modulate" ), 1.0f );
+    crtemu->Uniform1f( crtemu->blend_loc.modulate, 1.0f );
     crtemu->ActiveTexture( CRTEMU_GL_TEXTURE0 );
     crtemu->BindTexture( CRTEMU_GL_TEXTURE_2D, crtemu->backbuffer );   
     crtemu->ActiveTexture( CRTEMU_GL_TEXTURE1 );
@@ -1107,36 +1226,33 @@ void crtemu_present( crtemu_t* crtemu, CRTEMU_U64 time_us, CRTEMU_U32 const* pix
 
     crtemu->UseProgram( crtemu->crt_shader );
     
-    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->crt_shader, "backbuffer" ), 0 );
-    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->crt_shader, "blurbuffer" ), 1 );
-    crtemu->Uniform1i( crtemu->GetUniformLocation( crtemu->crt_shader, "frametexture" ), 2 );
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "use_frame" ), crtemu->use_frame );
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "time" ), 1.5f * (CRTEMU_GLfloat)( ( (double) time_us ) / 1000000.0 ) );
-    crtemu->Uniform2f( crtemu->GetUniformLocation( crtemu->crt_shader, "resolution" ), (float) window_width, (float) window_height );
+    crtemu->Uniform1f( crtemu->crt_loc.use_frame, crtemu->use_frame );
+    crtemu->Uniform1f( crtemu->crt_loc.time, 1.5f * (CRTEMU_GLfloat)( ( (double) time_us ) / 1000000.0 ) );
+    crtemu->Uniform2f( crtemu->crt_loc.resolution, (float) window_width, (float) window_height );
 
     float mod_r = ( ( mod_xbgr >> 16 ) & 0xff ) / 255.0f;
     float mod_g = ( ( mod_xbgr >> 8  ) & 0xff ) / 255.0f;
     float mod_b = ( ( mod_xbgr       ) & 0xff ) / 255.0f;
-    crtemu->Uniform3f( crtemu->GetUniformLocation( crtemu->crt_shader, "modulate" ), mod_r, mod_g, mod_b );
-
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "cfg_curvature" ), crtemu->config.curvature );
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "cfg_scanlines" ), crtemu->config.scanlines );
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "cfg_shadow_mask" ), crtemu->config.shadow_mask );
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "cfg_separation" ), crtemu->config.separation ); 
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "cfg_ghosting" ), crtemu->config.ghosting ); 
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "cfg_noise" ), crtemu->config.noise ); 
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "cfg_flicker" ), crtemu->config.flicker );
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "cfg_vignette" ), crtemu->config.vignette );
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "cfg_distortion" ), crtemu->config.distortion ); 
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "cfg_aspect_lock" ), crtemu->config.aspect_lock );
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "cfg_hpos" ), crtemu->config.hpos );
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "cfg_vpos" ), crtemu->config.vpos );
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "cfg_hsize" ), crtemu->config.hsize ); 
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "cfg_vsize" ), crtemu->config.vsize ); 
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "cfg_contrast" ), crtemu->config.contrast ); 
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "cfg_brightness" ), crtemu->config.brightness ); 
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "cfg_saturation" ), crtemu->config.saturation );
-    crtemu->Uniform1f( crtemu->GetUniformLocation( crtemu->crt_shader, "cfg_degauss" ), crtemu->config.degauss );
+    crtemu->Uniform3f( crtemu->crt_loc.modulate, mod_r, mod_g, mod_b );
+
+    crtemu->Uniform1f( crtemu->crt_loc.cfg_curvature, crtemu->config.curvature );
+    crtemu->Uniform1f( crtemu->crt_loc.cfg_scanlines, crtemu->config.scanlines );
+    crtemu->Uniform1f( crtemu->crt_loc.cfg_shadow_mask, crtemu->config.shadow_mask );
+    crtemu->Uniform1f( crtemu->crt_loc.cfg_separation, crtemu->config.separation ); 
+    crtemu->Uniform1f( crtemu->crt_loc.cfg_ghosting, crtemu->config.ghosting ); 
+    crtemu->Uniform1f( crtemu->crt_loc.cfg_noise, crtemu->config.noise ); 
+    crtemu->Uniform1f( crtemu->crt_loc.cfg_flicker, crtemu->config.flicker );
+    crtemu->Uniform1f( crtemu->crt_loc.cfg_vignette, crtemu->config.vignette );
+    crtemu->Uniform1f( crtemu->crt_loc.cfg_distortion, crtemu->config.distortion ); 
+    crtemu->Uniform1f( crtemu->crt_loc.cfg_aspect_lock, crtemu->config.aspect_lock );
+    crtemu->Uniform1f( crtemu->crt_loc.cfg_hpos, crtemu->config.hpos );
+    crtemu->Uniform1f( crtemu->crt_loc.cfg_vpos, crtemu->config.vpos );
+    crtemu->Uniform1f( crtemu->crt_loc.cfg_hsize, crtemu->config.hsize ); 
+    crtemu->Uniform1f( crtemu->crt_loc.cfg_vsize, crtemu->config.vsize ); 
+    crtemu->Uniform1f( crtemu->crt_loc.cfg_contrast, crtemu->config.contrast ); 
+    crtemu->Uniform1f( crtemu->crt_loc.cfg_brightness, crtemu->config.brightness ); 
+    crtemu->Uniform1f( crtemu->crt_loc.cfg_saturation, crtemu->config.saturation );
+    crtemu->Uniform1f( crtemu->crt_loc.cfg_degauss, crtemu->config.degauss );
 
     float color[] = { 0.0f, 0.0f, 0.0f, 0.0f };
 
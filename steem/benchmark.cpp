@@ -0,0 +1,430 @@
+/*---------------------------------------------------------------------------
+PROJECT: Steem SSE
+Atari ST emulator
+Copyright (C) 2020 by Anthony Hayward and Russel Hayward + SSE
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see https://www.gnu.org/licenses/.
+
+DOMAIN: Emu
+FILE: benchmark.cpp
+DESCRIPTION: Headless benchmark runner. It boots a TOS image (and optional
+disks) without X display or sound device, emulates a fixed number of
+frames as fast as it can and reports emulated MHz, frames per wall-second
+and the time spent in each subsystem.
+The runner is only in the Linux build made with 'make bench' (STEEM_BENCH).
+The timing scopes (TBenchmark::Switch()) are also used by the sound
+profiler (SSE_SOUND_PROFILE) in all builds.
+---------------------------------------------------------------------------*/
+
+#include "pch.h"
+#pragma hdrstop
+
+#if defined(STEEM_BENCH) || defined(SSE_SOUND_PROFILE)
+
+#include <mymisc.h>
+#include <benchmark.h>
+#if defined(STEEM_BENCH)
+#include <computer.h>
+#include <gui.h>
+#include <draw.h>
+#include <draw_threads.h>
+#include <display.h>
+#include <sound.h>
+#include <reset.h>
+#include <tos.h>
+#include <sys/resource.h>
+#endif
+
+TBenchmark Bench;
+
+
+TBenchmark::TBenchmark() {
+  ZeroMemory(SubsystemTime,sizeof(SubsystemTime));
+  LastSwitch=0;
+  Current=CPU;
+  Active=false;
+#if defined(STEEM_BENCH)
+  WallTime=Cycles=0;
+  LastAct=0;
+  nFrames=0;
+  FramesToRun=2000; // 40 seconds of PAL
+  Model=STF;
+  MemConf[0]=MEMCONF_512;
+  MemConf[1]=MEMCONF_512;
+#endif
+}
+
+
+void TBenchmark::Start() {
+  // time outside any scope is charged to CPU
+  Current=CPU;
+  LastSwitch=Now();
+  Active=true;
+}
+
+
+int TBenchmark::Switch(int subsystem) {
+  unsigned long long now=Now();
+  SubsystemTime[Current]+=now-LastSwitch;
+  LastSwitch=now;
+  int previous=Current;
+  Current=subsystem;
+  return previous;
+}
+
+
+void TBenchmark::Charge(int subsystem,unsigned long long ticks) {
+  // move time measured inside the current scope to another subsystem,
+  // for code too hot for a scope
+  Switch(Current);
+  ticks=MIN(ticks,SubsystemTime[Current]);
+  SubsystemTime[Current]-=ticks;
+  SubsystemTime[subsystem]+=ticks;
+}
+
+
+unsigned long long TBenchmark::SystemUs() {
+#ifdef WIN32
+  LARGE_INTEGER count,freq;
+  QueryPerformanceCounter(&count);
+  QueryPerformanceFrequency(&freq);
+  return (unsigned long long)(count.QuadPart/freq.QuadPart)*1000000ull
+    +(unsigned long long)(count.QuadPart%freq.QuadPart)*1000000ull
+    /freq.QuadPart;
+#else
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return (unsigned long long)ts.tv_sec*1000000ull+ts.tv_nsec/1000;
+#endif
+}
+
+#if defined(STEEM_BENCH)
+
+int TBenchmark::Main(int argc,char *argv[]) {
+  if(!ParseCommandLine(argc,argv))
+  {
+    PrintUsage();
+    return EXIT_FAILURE;
+  }
+  if(!Init())
+    return EXIT_FAILURE;
+  Run();
+  Report();
+  Disp.Release();
+  SoundRelease();
+  return EXIT_SUCCESS;
+}
+
+
+bool TBenchmark::ParseCommandLine(int argc,char *argv[]) {
+/*  steem-bench [options] tos.img [diskA [diskB]]
+    -frames=N   number of frames to emulate
+    -model=stf|ste|megast|megaste
+    -mem=512|1024|2048|4096 (Kb)
+*/
+  int ndisks=0;
+  for(int i=1;i<argc;i++)
+  {
+    char *arg=argv[i];
+    if(arg[0]=='-')
+    {
+      while(*arg=='-')
+        arg++;
+      char *val=strchr(arg,'=');
+      if(val)
+        *(val++)=0;
+      if(IsSameStr_I(arg,"frames") && val)
+        FramesToRun=MAX(atoi(val),1);
+      else if(IsSameStr_I(arg,"model") && val)
+      {
+        if(IsSameStr_I(val,"stf"))
+          Model=STF;
+        else if(IsSameStr_I(val,"ste"))
+          Model=STE;
+        else if(IsSameStr_I(val,"megast"))
+          Model=MEGA_ST;
+#if defined(SSE_MEGASTE)
+        else if(IsSameStr_I(val,"megaste"))
+          Model=MEGA_STE;
+#endif
+        else
+          return false;
+      }
+      else if(IsSameStr_I(arg,"mem") && val)
+      {
+        switch(atoi(val)) {
+        case 512:
+          MemConf[0]=MEMCONF_512;
+          MemConf[1]=MEMCONF_0;
+          break;
+        case 1024:
+          MemConf[0]=MEMCONF_512;
+          MemConf[1]=MEMCONF_512;
+          break;
+        case 2048:
+          MemConf[0]=MEMCONF_2MB;
+          MemConf[1]=MEMCONF_0;
+          break;
+        case 4096:
+          MemConf[0]=MEMCONF_2MB;
+          MemConf[1]=MEMCONF_2MB;
+          break;
+        default:
+          return false;
+        }
+      }
+      else
+        return false;
+    }
+    else if(TosFile.IsEmpty())
+      TosFile=arg;
+    else if(ndisks<2)
+      DiskFile[ndisks++]=arg;
+    else
+      return false;
+  }
+  return TosFile.NotEmpty();
+}
+
+
+void TBenchmark::PrintUsage() {
+  printf("Usage: steem-bench [-frames=N] [-model=stf|ste|megast|megaste]"
+    " [-mem=512|1024|2048|4096] tos.img [diskA [diskB]]\n");
+}
+
+
+bool TBenchmark::Init() {
+  RunDir.SetLength(MAX_PATH+1);
+  getcwd(RunDir,MAX_PATH);
+  NO_SLASH(RunDir);
+  WriteDir=RunDir;
+  ComputerRestore();
+  SSEConfig.make_Mem(MemConf[0],MemConf[1]);
+  SSEConfig.SwitchSTModel(Model);
+  if(draw_routines_init()==0)
+    return false;
+  if(load_TOS(TosFile))
+  {
+    printf("%s is not a valid TOS\n",TosFile.Text);
+    return false;
+  }
+  cpu_routines_init();
+  ChangeTimingFunctions();
+#if defined(SSE_HD6301_LL)
+  Ikbd.Init();
+#endif
+  // no GUI: draw every frame, never wait
+  bAppActive=true;
+  bAppMinimized=false;
+  PauseWhenInactive=false;
+  disable_speed_limiting=true;
+  frameskip=1;
+  FullScreen=0;
+  if(!Disp.InitNull())
+    return false;
+  x_sound_lib=XS_NULL;
+  InitSound();
+  OPTION_SAMPLED_YM=OPTION_MAME_YM=(Psg.LoadFixedVolTable()==true);
+  SSEOptions.low_pass_frequency=YM_LOW_PASS_FREQ;
+  power_on();
+  draw_init_resdependent();
+  for(int drive=0;drive<2;drive++)
+  {
+    if(DiskFile[drive].NotEmpty() && FloppyDrive[drive].SetDisk(DiskFile[drive]))
+    {
+      printf("Can't insert %s in drive %c\n",DiskFile[drive].Text,'A'+drive);
+      return false;
+    }
+  }
+  return true;
+}
+
+
+void TBenchmark::Run() {
+/*  This is run() stripped of everything GUI. The main loop is the same,
+    time is charged to CPU, events, and through BENCH_SCOPE to video and sound.
+*/
+  ComputerRestore();
+  runstate=RUNSTATE_RUNNING;
+  Glue.m_Status.stop_emu=0;
+  ikbd_run_start(LITTLE_PC==rom_addr);
+  timer=timeGetTime();
+  Sound_Start();
+  Glue.AddFreqChange(Glue.video_freq);
+  init_screen();
+  draw_begin();
+  timer=timeGetTime();
+  run_start_time=timer;
+  frameskip_count=1;
+  ioaccess=0;
+  if(Blitter.Busy)
+    Blitter_Draw();
+  ZeroMemory(SubsystemTime,sizeof(SubsystemTime));
+  nFrames=0;
+  Cycles=0;
+#if defined(SSE_CPU_IDLE_LOOP)
+  IdleLoop.SkippedCycles=0;
+#endif
+#if defined(SSE_VID_LINE_CACHE)
+  ScanlineCache.nHit=ScanlineCache.nMiss=ScanlineCache.nSkippedFrames=0;
+#endif
+#if defined(SSE_VID_DRAW_THREADS)
+  DrawThreads.nConverted=DrawThreads.nSync=DrawThreads.nDirect=0;
+#endif
+  LastAct=ACT;
+  Start();
+  WallTime=LastSwitch;
+  bool ExcepHappened;
+  do {
+    ExcepHappened=0;
+    TRY_M68K_EXCEPTION
+      while(runstate==RUNSTATE_RUNNING)
+      {
+        while(cpu_cycles>0&&runstate==RUNSTATE_RUNNING)
+          m68kProcess();
+        BENCH_SCOPE(EVENTS);
+        while(cpu_cycles<=0 && runstate==RUNSTATE_RUNNING)
+        {
+          event_vector();
+          prepare_next_event();
+        }
+      }
+    CATCH_M68K_EXCEPTION
+      m68k_exception e=ExceptionObject;
+      ExcepHappened=true;
+      Switch(CPU); // longjmp skipped the scope destructors
+      e.crash();
+    END_M68K_EXCEPTION
+  } while(ExcepHappened);
+  Switch(CPU);
+  WallTime=Now()-WallTime;
+  Active=false;
+  Sound_Stop();
+  runstate=RUNSTATE_STOPPED;
+  draw_end();
+}
+
+
+void TBenchmark::Vbl() {
+  Cycles+=(DWORD)(ACT-LastAct);
+  LastAct=ACT;
+  if(++nFrames>=FramesToRun)
+    runstate=RUNSTATE_STOPPING;
+}
+
+
+void TBenchmark::Report() {
+  const char *subsystem_name[NSUBSYSTEMS]={"cpu","events","video","sound",
+    "sound psg","sound antialias","sound microwire","sound mix",
+    "sound device"};
+  double seconds=(double)WallTime/1e9;
+  if(seconds<=0)
+    return;
+  rusage usage;
+  getrusage(RUSAGE_SELF,&usage);
+  double user=usage.ru_utime.tv_sec+usage.ru_utime.tv_usec/1e6;
+  double sys=usage.ru_stime.tv_sec+usage.ru_stime.tv_usec/1e6;
+  printf("frames           %u\n",(unsigned)nFrames);
+  printf("wall time        %.3f s\n",seconds);
+  printf("frames/s         %.2f (%.1f%% of %dHz)\n",nFrames/seconds,
+    nFrames/seconds*100/Glue.video_freq,Glue.video_freq);
+  printf("emulated MHz     %.3f\n",Cycles/seconds/1e6);
+#if defined(SSE_CPU_IDLE_LOOP)
+  printf("idle skipped     %.1f%% of cycles\n",
+    (Cycles) ? (double)IdleLoop.SkippedCycles*100/Cycles : 0.0);
+#endif
+#if defined(SSE_VID_LINE_CACHE)
+  COUNTER_VAR lines=ScanlineCache.nHit+ScanlineCache.nMiss;
+  printf("line cache       %.1f%% hits (%u hits, %u misses)\n",
+    (lines) ? (double)ScanlineCache.nHit*100/lines : 0.0,
+    (unsigned)ScanlineCache.nHit,(unsigned)ScanlineCache.nMiss);
+  if(ScanlineCache.SkipUnchanged)
+    printf("unchanged frames %u not blitted\n",
+      (unsigned)ScanlineCache.nSkippedFrames);
+#endif
+#if defined(SSE_VID_DRAW_THREADS)
+  if(DrawThreads.Threads)
+    printf("draw threads     %d, %u commands, %u waits, %u drawn inline\n",
+      DrawThreads.nThreads,(unsigned)DrawThreads.nConverted,
+      (unsigned)DrawThreads.nSync,(unsigned)DrawThreads.nDirect);
+#endif
+  printf("process cpu      %.3f s user, %.3f s sys\n",user,sys);
+  for(int i=0;i<NSUBSYSTEMS;i++)
+    printf("%-16s %.3f s (%.1f%%)\n",subsystem_name[i],SubsystemTime[i]/1e9,
+      SubsystemTime[i]/1e7/seconds);
+}
+
+
+/*  Null sound backend. There's no device, the play cursor (sample count,
+    like Rt_GetTime()) advances with emulated time so that Sound_VBL() writes
+    as much as it would when running at normal speed.
+*/
+
+static bool null_started=false;
+static COUNTER_VAR null_last_act;
+static unsigned long long null_sample_frac; // in cycles*sound_freq
+
+
+HRESULT Null_Init() {
+  UseSound=XS_NULL;
+  return DS_OK;
+}
+
+
+DWORD Null_GetTime() {
+  if(null_started)
+  {
+    null_sample_frac+=(unsigned long long)(DWORD)(ACT-null_last_act)
+      *(unsigned long long)sound_freq;
+    null_last_act=ACT;
+    thread_atomic_int_add(&sound_buf_pointer,
+      (int)(null_sample_frac/n_cpu_cycles_per_second));
+    null_sample_frac%=n_cpu_cycles_per_second;
+  }
+  return thread_atomic_int_load(&sound_buf_pointer);
+}
+
+
+void Null_Release() {
+  null_started=false;
+}
+
+
+HRESULT Null_StartBuffer(int flatlevel1,int flatlevel2) {
+  if(!sound_bytes_per_sample)
+    return DSERR_GENERIC;
+  sound_freq=sound_chosen_freq;
+  sound_buffer_length=X_SOUND_BUF_LEN_BYTES/sound_bytes_per_sample;
+  XSoundInitBuffer(flatlevel1,flatlevel2);
+  thread_atomic_int_store(&sound_buf_pointer,0); // sample count
+  null_last_act=ACT;
+  null_sample_frac=0;
+  null_started=true;
+  return DS_OK;
+}
+
+
+bool Null_IsPlaying() {
+  return null_started;
+}
+
+
+HRESULT Null_Stop(bool) {
+  null_started=false;
+  return DSERR_GENERIC;
+}
+
+#endif//STEEM_BENCH
+
+#endif//STEEM_BENCH || SSE_SOUND_PROFILE
@@ -277,6 +277,14 @@ extern "C" void ASMCALL osd_black_box_32(void*,int,int,int,int,long){}
 
 #define CALC_COL_HIRES_AND_DRAWPIXEL(mask) DRAWPIXEL((w0&mask)?fore:back)
 
+
+#if defined(SSE_VID_DRAW_C_SIMD)
+// Full rasters by the SSE2/AVX2 kernels of draw.cpp
+#define DRAW_C_BLOCKS(nblocks,nplanes,pal) \
+  draw_dest_ad=draw_c_blocks(Mem_End_minus_2-source,nblocks,nplanes,pal, \
+    draw_dest_ad,draw_line_length,DRAW_C_SIMD_LAYOUT);
+#endif
+
 #if !defined(SSE_VID_32BIT_ONLY)
 
 #define DRAW_2_BORDER_PIXELS  *LPWORD(draw_dest_ad)=*LPWORD(PCpal);draw_dest_ad+=2;
@@ -383,6 +391,11 @@ extern "C" void ASMCALL draw_scanline_24_medres_pixelwise(int border1,int pictur
 }
 
 
+#if defined(SSE_VID_DRAW_C_SIMD)
+#define DRAW_C_SIMD_LAYOUT 1,false // width, two lines
+#endif
+
+
 extern "C" void ASMCALL draw_scanline_32_lowres_pixelwise(int border1,int picture,int border2,int hscroll){
 #include "draw_c_lowres_scanline.cpp"
 }
@@ -398,6 +411,7 @@ extern "C" void ASMCALL draw_scanline_32_medres_pixelwise(int border1,int pictur
 #undef DRAWPIXEL
 #undef DRAWPIXEL_MEDRES
 #undef DRAW_BORDER_PIXELS 
+#undef DRAW_C_SIMD_LAYOUT
 
 #define DRAW_BORDER_PIXELS DRAW_BORDER_PIXELS_A
 
@@ -468,11 +482,19 @@ extern "C" void ASMCALL draw_scanline_24_lowres_pixelwise_dw(int border1,int pic
 #define DRAWPIXEL(s_add)  *(((DWORD*)(draw_dest_ad)))=*(DWORD*)(s_add),draw_dest_ad+=4;*(((DWORD*)(draw_dest_ad)))=*(DWORD*)(s_add),draw_dest_ad+=4;
 
 
+#if defined(SSE_VID_DRAW_C_SIMD)
+#define DRAW_C_SIMD_LAYOUT 2,false
+#endif
+
+
 extern "C" void ASMCALL draw_scanline_32_lowres_pixelwise_dw(int border1,int picture,int border2,int hscroll){
 #include "draw_c_lowres_scanline.cpp"
 }
 
 
+#undef DRAW_C_SIMD_LAYOUT
+
+
 #undef DRAW_2_BORDER_PIXELS
 #undef DRAWPIXEL
 
@@ -603,16 +625,30 @@ extern "C" void ASMCALL draw_scanline_24_medres_pixelwise_400(int border1,int pi
                           *(((DWORD*)(draw_dest_ad)))=*(DWORD*)(s_add),draw_dest_ad+=4;
 
 
+#if defined(SSE_VID_DRAW_C_SIMD)
+#define DRAW_C_SIMD_LAYOUT 2,true
+#endif
+
+
 extern "C" void ASMCALL draw_scanline_32_lowres_pixelwise_400(int border1,int picture,int border2,int hscroll){
 #include "draw_c_lowres_scanline.cpp"
 }
 
 
+#if defined(SSE_VID_DRAW_C_SIMD)
+#undef DRAW_C_SIMD_LAYOUT
+#define DRAW_C_SIMD_LAYOUT 1,true
+#endif
+
+
 extern "C" void ASMCALL draw_scanline_32_medres_pixelwise_400(int border1,int picture,int border2,int hscroll){
 #include "draw_c_medres_scanline.cpp"
 }
 
 
+#undef DRAW_C_SIMD_LAYOUT
+
+
 #undef DRAW_2_BORDER_PIXELS
 #undef DRAWPIXEL
 #undef DRAWPIXEL_MEDRES
@@ -672,9 +708,15 @@ extern "C" void ASMCALL draw_scanline_24_hires(int border1,int picture,int borde
 #undef DRAWPIXEL
 #define DRAWPIXEL(col) *(((DWORD*)draw_dest_ad))=DWORD(col),draw_dest_ad+=4;
 
+#if defined(SSE_VID_DRAW_C_SIMD)
+#define DRAW_C_SIMD_LAYOUT 1,false
+#endif
+
 extern "C" void ASMCALL draw_scanline_32_hires(int border1,int picture,int border2,int){
 #include "draw_c_hires_scanline.cpp"
 }
 
+#undef DRAW_C_SIMD_LAYOUT
+
 #undef DRAWPIXEL
 
@@ -17,6 +17,15 @@ DESCRIPTION: High res C++ drawing routine
   MEM_ADDRESS source;
   GET_START(0,80)
   DRAW_BORDER_PIXELS(border1*16)
+#if defined(DRAW_C_SIMD_LAYOUT)
+  if(draw_c_blocks && picture>0)
+  {
+    DWORD back_fore[8]={back,fore};
+    DRAW_C_BLOCKS(picture,1,back_fore)
+    source+=picture*2;
+    picture=0;
+  }
+#endif
   for(n=picture;n>0;n--){
     GET_SCREEN_DATA_INTO_REGS_AND_INC_SA_HIRES
       for(int mask=BIT_15;mask;mask>>=1)
@@ -23,7 +23,16 @@ DESCRIPTION: Med res C++ drawing routine
         mask>>=1;
       }
     }
-    for(n=picture/16;n>0;n--){
+    n=picture/16;
+#if defined(DRAW_C_SIMD_LAYOUT)
+    if(draw_c_blocks && n)
+    {
+      DRAW_C_BLOCKS(n,2,(DWORD*)PCpal)
+      source+=n*4;
+      n=0;
+    }
+#endif
+    for(;n>0;n--){
       GET_SCREEN_DATA_INTO_REGS_AND_INC_SA_MEDRES
       for(int mask=BIT_15;mask;mask>>=1)
       {
@@ -81,6 +81,10 @@ DU32 uiabus; // AOB
 MEM_ADDRESS &iabus=uiabus.d32;
 WORD &iabush=uiabus.d16[HI];
 WORD &iabusl=uiabus.d16[LO];
+BYTE d8; // meta 8bit register for peek (can be dbush or dbusl)
+#if defined(SSE_CPU_SPECIALISED_TIMING)
+void (*cpu_routines_installed)()=NULL;
+#endif
 DU32 ueffective_address;
 DWORD &effective_address=ueffective_address.d32;
 WORD &effective_address_h=ueffective_address.d16[HI];
@@ -394,6 +398,25 @@ void ChangeTimingFunctions() {
   if(OPTION_FASTBLITTER)
     pInstructionTimeBltRead=pInstructionTimeBltWrite=dummy;
 #endif
+#if defined(SSE_CPU_SPECIALISED_TIMING)
+/*  The opcode and EA tables get handlers compiled for the timing functions
+    we just selected (cpu_model.cpp), so they don't go through the pointers.
+    Low-level video (STVL) timings use the generic handlers. The pointers
+    are still used by blitter, DMA and IO code.
+*/
+  void (*routines_init)()=cpu_routines_init;
+  if(pInstructionTimePrefetchTotal==InstructionTimeStfPrefetchTotal)
+    routines_init=CpuStf::cpu_routines_init;
+  else if(pInstructionTimePrefetchTotal==InstructionTimeStePrefetchTotal)
+    routines_init=CpuSte::cpu_routines_init;
+#if defined(SSE_MEGASTE)
+  else if(pInstructionTimePrefetchTotal==InstructionTimeMegaStePrefetchTotal)
+    routines_init=CpuMegaSte::cpu_routines_init;
+#endif
+  if(routines_init!=cpu_routines_installed)
+    routines_init();
+#endif
+  MMU_UPDATE_PAGE_TABLE // TOS range depends on the model
 }
 
 
@@ -1171,10 +1194,11 @@ Bus error           | 50(4/7)  |     nn ns nS ns ns ns nS ns nV nv np n np
       crash_ird=IR;
       TRACE_LOG("TVN latched IR %04X I/N %d\n",crash_ird,inExcept01);
       // test is heavy but it's rarely necessary
+      // handlers may be specialised, compare with table entries
       if(Cpu.tpend || check_ipl() || m68k_call_table[crash_ird]==m68k_trap1
         || (crash_sr&0x2000)==0 && Cpu.IsPriv(crash_ird)
-        || m68k_call_table[crash_ird]==m68k_lineA
-        || m68k_call_table[crash_ird]==m68k_lineF)
+        || m68k_call_table[crash_ird]==m68k_call_table[0xA000] // line-A
+        || m68k_call_table[crash_ird]==m68k_call_table[0xF000]) // line-F
         inExcept01=true; // I/N bit affected
     }
     // The GLUE contains a 6bit counter that asserts BERR if AS stays asserted 
@@ -1309,13 +1333,15 @@ void DebugCheckIOAccess() {
 
 
 bool TMC68000::IsPriv(WORD op) { // it's less heavy than a flag in a big opcode table
+  // we compare with the entries of reference opcodes, not with the functions
+  // (see SSE_CPU_SPECIALISED_TIMING)
   bool is_priv=(op==0x4E70 || op==0x4E72 || op==0x4E73 // reset||stop||rte
-   || m68k_call_table[op]==m68k_ori_w_to_sr
-   || m68k_call_table[op]==m68k_andi_w_to_sr
-   || m68k_call_table[op]==m68k_eori_w_to_sr
-   || m68k_call_table[op]==m68k_move_to_sr
-   || m68k_call_table[op]==m68k_move_to_usp
-   || m68k_call_table[op]==m68k_move_from_usp);
+   || m68k_call_table[op]==m68k_call_table[0x007C] // ori #,sr
+   || m68k_call_table[op]==m68k_call_table[0x027C] // andi #,sr
+   || m68k_call_table[op]==m68k_call_table[0x0A7C] // eori #,sr
+   || m68k_call_table[op]==m68k_call_table[0x46C0] // move d0,sr
+   || m68k_call_table[op]==m68k_call_table[0x4E60] // move a0,usp
+   || m68k_call_table[op]==m68k_call_table[0x4E68]); // move usp,a0
   return is_priv;
 }
 
@@ -1383,6 +1409,66 @@ BYTE check_ipl() {
 }
 
 
+#if defined(SSE_CPU_IDLE_LOOP)
+
+/*  Typical case: TOS or a game waiting for the VBL
+      loop: cmp.l $466.w,d0
+            beq.s loop
+    or the CPU in STOP state (pc doesn't move).
+    Memory is only read, so it can only change through an event (interrupt
+    handler, DMA...). If an iteration started and ended with the same CPU
+    state, without event nor write nor IO access in between, the next ones
+    will be identical: same reads, same timing. We remove the cycles of
+    as many iterations as fit before the next event and the loop goes on
+    normally from there. Timing is the same as if we had emulated them.
+    We need one iteration to arm (no side effects), one to record the state,
+    the next one is checked.
+*/
+
+TIdleLoop IdleLoop;
+
+void TIdleLoop::Check() {
+  if(Impure || pc!=Pc)
+  {
+    Pc=pc;
+    Recorded=false;
+    Impure=false;
+    return;
+  }
+  if(Recorded && Start!=ACT && SR==sr && uflags.d64==Flags 
+    && (cpu_cycles&3)==Alignment && !memcmp(Cpu.r,r,sizeof(r))
+    && !Blitter.Busy && !Blitter.Request && !PSWT
+#if defined(SSE_MEGASTE)
+    && !IS_MEGASTE // memory cache
+#endif
+    && !OPTION_C3
+    // no interrupt can become visible during the skipped iterations
+    && tvn_latch_time-ipl_timing[ipl_timing_index].time>=DBI_DELAY)
+  {
+    int period=(int)(ACT-Start);
+    int iterations=(cpu_cycles-1)/period;
+    if(iterations>0)
+    {
+      cpu_cycles-=iterations*period;
+      // the CPU increments this counter for each access
+      Blitter.BusAccessCounter+=(BYTE)(iterations
+        *(BYTE)(Blitter.BusAccessCounter-BusAccesses));
+      SkippedCycles+=iterations*period;
+    }
+  }
+  // record state at loop start
+  Start=ACT;
+  Flags=uflags.d64;
+  memcpy(r,Cpu.r,sizeof(r));
+  sr=SR;
+  Alignment=(BYTE)(cpu_cycles&3);
+  BusAccesses=Blitter.BusAccessCounter;
+  Recorded=true;
+}
+
+#endif
+
+
 #undef LOGSECTION
 #define LOGSECTION LOGSECTION_CPU
 
@@ -1494,6 +1580,10 @@ void m68kProcess() { // process one instruction
     }
     break;
   }//sw
+#if defined(SSE_CPU_IDLE_LOOP)
+  if(pc<=old_pc && old_pc-pc<=IDLE_LOOP_MAX_BYTES) // branch back or STOP
+    IdleLoop.Check();
+#endif
 #ifdef DEBUG_BUILD
   if(ioaccess&(IOACCESS_DEBUG_MEM_WRITE_LOG|IOACCESS_DEBUG_MEM_READ_LOG))
   {
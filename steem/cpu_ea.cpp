@@ -28,8 +28,6 @@ DESCRIPTION: Functions for MC68000 Effective Address (EA), Read/Write (RW)
 
 // peek (byte), dpeek (word)
 
-BYTE d8; // meta 8bit register for peek (can be dbush or dbusl)
-
 /*  Peek/poke functions can be used generally, not only for CPU emulation.
     STF and STE have different ROM addresses for both the TOS and, potentially,
     the cartridge.
@@ -47,6 +45,15 @@ BYTE m68k_peek_stf(MEM_ADDRESS ad) {
   MEM_ADDRESS byte_index=bit0^1;
 #endif
   MEM_ADDRESS fake_abus=abus+bit0;
+#if defined(SSE_MMU_PAGE_TABLE) && !defined(DEBUG_BUILD)
+  BYTE *page_base=mmu_page_base[abus>>MMU_PAGE_SHIFT];
+  if(page_base) // RAM, TOS
+  {
+    d8=MMU_PAGE_PEEK(page_base,fake_abus);
+    udbus.d8[byte_index]=d8;
+    return d8;
+  }
+#endif
   d8=0xff; // default
   // RAM
   if(abus<FOUR_MEGS)
@@ -130,6 +137,15 @@ BYTE m68k_peek_ste(MEM_ADDRESS ad) {
   MEM_ADDRESS byte_index=bit0^1;
 #endif
   MEM_ADDRESS fake_abus=abus+bit0;
+#if defined(SSE_MMU_PAGE_TABLE) && !defined(DEBUG_BUILD)
+  BYTE *page_base=mmu_page_base[abus>>MMU_PAGE_SHIFT];
+  if(page_base) // RAM, TOS
+  {
+    d8=MMU_PAGE_PEEK(page_base,fake_abus);
+    udbus.d8[byte_index]=d8;
+    return d8;
+  }
+#endif
   //BYTE 
   d8=0xff; // default
   // RAM
@@ -209,6 +225,14 @@ BYTE m68k_peek_ste(MEM_ADDRESS ad) {
 
 WORD m68k_dpeek_stf(MEM_ADDRESS ad) {
   abus=(ad&0xfffffe);
+#if defined(SSE_MMU_PAGE_TABLE) && !defined(DEBUG_BUILD)
+  BYTE *page_base=mmu_page_base[abus>>MMU_PAGE_SHIFT];
+  if(page_base && !(ad&1)) // RAM, TOS
+  {
+    dbus=MMU_PAGE_DPEEK(page_base,abus);
+    return dbus;
+  }
+#endif
   dbus=0xffff; // default
   if(ad&1)
     exception(BOMBS_ADDRESS_ERROR,EA_READ,abus);
@@ -284,6 +308,14 @@ WORD m68k_dpeek_stf(MEM_ADDRESS ad) {
 
 WORD m68k_dpeek_ste(MEM_ADDRESS ad) {
   abus=(ad&0xfffffe);
+#if defined(SSE_MMU_PAGE_TABLE) && !defined(DEBUG_BUILD)
+  BYTE *page_base=mmu_page_base[abus>>MMU_PAGE_SHIFT];
+  if(page_base && !(ad&1)) // RAM, TOS
+  {
+    dbus=MMU_PAGE_DPEEK(page_base,abus);
+    return dbus;
+  }
+#endif
   dbus=0xffff; // default
   if(ad&1)
     exception(BOMBS_ADDRESS_ERROR,EA_READ,abus);
@@ -370,6 +402,15 @@ DWORD m68k_lpeek(MEM_ADDRESS ad) {
 // fetch
 
 WORD m68k_fetch_stf(MEM_ADDRESS ad) {
+#if defined(SSE_MMU_PAGE_TABLE)
+  // abus was set by the caller
+  BYTE *page_base=mmu_page_base[abus>>MMU_PAGE_SHIFT];
+  if(page_base && !(ad&1)) // RAM, TOS
+  {
+    dbus=MMU_PAGE_DPEEK(page_base,abus);
+    return dbus;
+  }
+#endif
   dbus=0xffff; // default
   if(ad&1)
     exception(BOMBS_ADDRESS_ERROR,EA_FETCH,ad);
@@ -432,6 +473,15 @@ WORD m68k_fetch_stf(MEM_ADDRESS ad) {
 
 
 WORD m68k_fetch_ste(MEM_ADDRESS ad) {
+#if defined(SSE_MMU_PAGE_TABLE)
+  // abus was set by the caller
+  BYTE *page_base=mmu_page_base[abus>>MMU_PAGE_SHIFT];
+  if(page_base && !(ad&1)) // RAM, TOS
+  {
+    dbus=MMU_PAGE_DPEEK(page_base,abus);
+    return dbus;
+  }
+#endif
   dbus=0xffff; // default
   if(ad&1)
     exception(BOMBS_ADDRESS_ERROR,EA_FETCH,ad);
@@ -500,6 +550,7 @@ WORD m68k_fetch_ste(MEM_ADDRESS ad) {
 
 
 void m68k_poke_abus(BYTE x) {
+  IDLE_LOOP_IMPURE
   MEM_ADDRESS fake_abus=(iabus&0xffffff);
   abus=(iabus&0xfffffe);
   if(abus>=MEM_IO_BASE)
@@ -538,6 +589,7 @@ void m68k_poke_abus(BYTE x) {
 
 
 void m68k_dpoke_abus(WORD x) {
+  IDLE_LOOP_IMPURE
   abus=(iabus&0xfffffe);
   if(iabus&1)
     exception(BOMBS_ADDRESS_ERROR,EA_WRITE,abus);
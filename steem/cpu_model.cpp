@@ -0,0 +1,127 @@
+/*---------------------------------------------------------------------------
+PROJECT: Steem SSE
+Atari ST emulator
+Copyright (C) 2020 by Anthony Hayward and Russel Hayward + SSE
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see https://www.gnu.org/licenses/.
+
+DOMAIN: Emu
+FILE: cpu_model.cpp
+DESCRIPTION: The CPU emulation (cpu_ea.cpp, cpu_op.cpp, cpuinit.cpp)
+compiled again for each timing model, in its own namespace.
+In those copies, the timing macros (PREFETCH, CPU_BUS_ACCESS_READ...) call
+the model's timing functions directly instead of going through the
+pInstructionTime* pointers. This spares an indirect call for each bus access
+and lets the compiler (link-time code generation) inline them.
+ChangeTimingFunctions() calls the cpu_routines_init() of the namespace
+matching the pointers it selected, the opcode and EA tables are then filled
+with those handlers. The generic handlers remain for low-level video (STVL).
+Timing is the same, it's the same code.
+---------------------------------------------------------------------------*/
+
+#include "pch.h"
+#pragma hdrstop
+
+#if defined(SSE_CPU_SPECIALISED_TIMING)
+
+// all headers used by the included files must be included here, out of the
+// namespaces (they're guarded so the includes in the files do nothing)
+#include <computer.h>
+#include <interface_stvl.h>
+#include <cpu.h>
+#include <cpu_op.h>
+
+#undef CPU_BUS_IDLE
+#undef PREFETCH
+#undef PREFETCH_FINAL
+#undef PREFETCH_ONLY
+#undef CPU_BUS_ACCESS_READ
+#undef CPU_BUS_ACCESS_READ_B
+#undef CPU_BUS_ACCESS_WRITE
+#undef CPU_BUS_ACCESS_WRITE_B
+
+#define CPU_TIMING2(model,f) InstructionTime##model##f
+#define CPU_TIMING(model,f) CPU_TIMING2(model,f)
+
+#define CPU_BUS_IDLE(t)               CPU_TIMING(CPU_MODEL,Idle)(t)
+#define PREFETCH                      CPU_TIMING(CPU_MODEL,PrefetchTotal)();
+#define PREFETCH_FINAL                CPU_TIMING(CPU_MODEL,PrefetchFinal)();
+#define PREFETCH_ONLY                 CPU_TIMING(CPU_MODEL,PrefetchOnly)();
+#define CPU_BUS_ACCESS_READ           CPU_TIMING(CPU_MODEL,Read)()
+#define CPU_BUS_ACCESS_READ_B         CPU_TIMING(CPU_MODEL,ReadB)()
+#define CPU_BUS_ACCESS_WRITE          CPU_TIMING(CPU_MODEL,WriteW)()
+#define CPU_BUS_ACCESS_WRITE_B        CPU_TIMING(CPU_MODEL,WriteB)()
+
+// the inline functions of cpu.h were compiled with the pointers
+#undef m68k_GET_IMMEDIATE_L_WITH_TIMING
+#undef WRITE_LONG_BACKWARDS
+#undef m68k_PUSH_L_WITH_TIMING
+
+#define m68k_GET_IMMEDIATE_L_WITH_TIMING do{\
+  m68k_src_lh=IRC;\
+  PREFETCH; /*np*/\
+  m68k_src_ll=IRC;\
+  PREFETCH; /*np*/\
+}while(0)
+
+#define WRITE_LONG_BACKWARDS do{\
+  dbus=resultl;\
+  CPU_BUS_ACCESS_WRITE; /*nw*/\
+  iabus-=2;\
+  dbus=resulth;\
+  CPU_BUS_ACCESS_WRITE; /*nW*/\
+}while(0)
+
+#define m68k_PUSH_L_WITH_TIMING(x) do{\
+  AREG(7)-=4;\
+  iabus=AREG(7);\
+  dbus=(x).d16[HI];\
+  CPU_BUS_ACCESS_WRITE; /*nS*/\
+  iabus+=2;\
+  dbus=(x).d16[LO];\
+  CPU_BUS_ACCESS_WRITE; /*ns*/\
+}while(0)
+
+/*  Mega ST without STVL uses the STE functions, see ChangeTimingFunctions().
+    Handlers that call other handlers defined further in the file call the
+    generic version, which is correct, only slower.
+*/
+
+#define CPU_MODEL Stf
+namespace CpuStf {
+#include "cpu_ea.cpp"
+#include "cpu_op.cpp"
+#include "cpuinit.cpp"
+}
+#undef CPU_MODEL
+
+#define CPU_MODEL Ste
+namespace CpuSte {
+#include "cpu_ea.cpp"
+#include "cpu_op.cpp"
+#include "cpuinit.cpp"
+}
+#undef CPU_MODEL
+
+#if defined(SSE_MEGASTE)
+#define CPU_MODEL MegaSte
+namespace CpuMegaSte {
+#include "cpu_ea.cpp"
+#include "cpu_op.cpp"
+#include "cpuinit.cpp"
+}
+#undef CPU_MODEL
+#endif
+
+#endif//SSE_CPU_SPECIALISED_TIMING
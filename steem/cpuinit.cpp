@@ -20,6 +20,7 @@ DOMAIN: Emu
 FILE: cpuinit.cpp
 DESCRIPTION: Initialisation for CPU jump tables (opcodes and effective 
 address). This file contains only one function, cpu_routines_init().
+It is also compiled once per model in cpu_model.cpp.
 ---------------------------------------------------------------------------*/
 
 #include "pch.h"
@@ -35,6 +36,9 @@ address). This file contains only one function, cpu_routines_init().
     Other advantage: Illegal trapped at once.
 */
 void cpu_routines_init() {
+#if defined(SSE_CPU_SPECIALISED_TIMING)
+  cpu_routines_installed=cpu_routines_init; // generic or specialised
+#endif
   for(DWORD op=0;op<=0xffff;op++) // there are $FFFF + 1 entries
   {
     m68k_call_table[op]=m68k_trap1; // default
@@ -37,6 +37,7 @@ a lot of them) to and from the ini file.
 #include <options.h>
 #include <archive.h>
 #include <draw.h>
+#include <draw_threads.h>
 #include <palette.h>
 #include <harddiskman.h>
 #include <key_table.h>
@@ -1072,6 +1073,16 @@ bool TOptionBox::LoadData(bool FirstLoad,TConfigStoreFile *pCSF,
 #endif
 #if defined(SSE_VID_D3D_FLIPEX)
     OPTION_FLIPEX=pCSF->GetByte("Display","FlipEx",OPTION_FLIPEX);
+#endif
+#if defined(SSE_VID_LINE_CACHE)
+    ScanlineCache.Enabled=pCSF->GetByte("Display","LineCache",
+      ScanlineCache.Enabled);
+    ScanlineCache.SkipUnchanged=pCSF->GetByte("Display","SkipUnchanged",
+      ScanlineCache.SkipUnchanged);
+#endif
+#if defined(SSE_VID_DRAW_THREADS)
+    DrawThreads.Threads=pCSF->GetByte("Display","DrawThreads",
+      DrawThreads.Threads);
 #endif
     OPTION_ST_ASPECT_RATIO=pCSF->GetByte("Display","STAspectRatio",
       OPTION_ST_ASPECT_RATIO);
@@ -1277,6 +1288,8 @@ bool TOptionBox::LoadData(bool FirstLoad,TConfigStoreFile *pCSF,
 #endif
     OPTION_SOUND_RECORD_FORMAT=(BYTE)pCSF->GetInt("Sound","SoundRecordFormat",
       OPTION_SOUND_RECORD_FORMAT);
+    if(OPTION_SOUND_RECORD_FORMAT>=TOption::NSoundFormats) // eg FLAC, not in this build
+      OPTION_SOUND_RECORD_FORMAT=TOption::SoundFormatWav;
 #if defined(SSE_YM2149_LL)
     OPTION_MAME_YM=pCSF->GetByte("Sound","YmLowLevel",OPTION_MAME_YM);
     OPTION_SAMPLED_YM=OPTION_MAME_YM; // it used to be an apart option
@@ -1295,6 +1308,9 @@ bool TOptionBox::LoadData(bool FirstLoad,TConfigStoreFile *pCSF,
 #endif
     MuteWhenInactive=pCSF->GetBool("Sound","MuteWhenInactive",
       MuteWhenInactive);
+#if defined(SSE_SOUND_PROFILE)
+    SoundProfile.Mode=pCSF->GetByte("Sound","Profile",SoundProfile.Mode);
+#endif
   }
   if(FirstLoad)
   {
@@ -1549,6 +1565,14 @@ bool TOptionBox::SaveData(bool FinalSave,TConfigStoreFile *pCSF) {
 #if defined(SSE_VID_D3D_FLIPEX)
   pCSF->SetStr("Display","FlipEx",EasyStr(OPTION_FLIPEX));
 #endif
+#if defined(SSE_VID_LINE_CACHE)
+  pCSF->SetStr("Display","LineCache",EasyStr(ScanlineCache.Enabled));
+  pCSF->SetStr("Display","SkipUnchanged",
+    EasyStr(ScanlineCache.SkipUnchanged));
+#endif
+#if defined(SSE_VID_DRAW_THREADS)
+  pCSF->SetStr("Display","DrawThreads",EasyStr(DrawThreads.Threads));
+#endif
 #if defined(SSE_GUI_TOOLBAR)
   pCSF->SetStr("Main","ToolbarTaskbar",EasyStr(OPTION_TOOLBAR_TASKBAR));
   pCSF->SetStr("Main","ToolbarVertical",EasyStr(OPTION_TOOLBAR_VERTICAL));
@@ -1663,6 +1687,9 @@ bool TOptionBox::SaveData(bool FinalSave,TConfigStoreFile *pCSF) {
   pCSF->SetStr("Sound","InternalSpeaker",Str(sound_internal_speaker));
 #endif
   pCSF->SetStr("Sound","SoundRecordFormat",Str(OPTION_SOUND_RECORD_FORMAT));
+#if defined(SSE_SOUND_PROFILE)
+  pCSF->SetStr("Sound","Profile",EasyStr(SoundProfile.Mode));
+#endif
 #if defined(SSE_SOUND_OPTION_DISABLE_DSP)
   pCSF->SetStr("Sound","NoDsp",EasyStr(DSP_DISABLED));
 #endif
@@ -58,11 +58,12 @@ This contains the DirectDraw, Direct3D and X code used by Steem for output.
 
     #define FRAMETIMER_IMPLEMENTATION
     #include "..\..\frametimer.h"
+#endif
 
-    #define THREAD_IMPLEMENTATION
-    #include "..\..\thread.h"
-    #undef WINVER
-    #undef _WIN32_WINNT
+#ifdef STEEM_CRT
+// CRTlatestFrame = buffer index + fresh flag
+#define CRT_FRAME_INDEX 3
+#define CRT_FRAME_FRESH 4
 #endif
 
 BYTE FullScreen=0;
@@ -426,9 +427,8 @@ TSteemDisplay::TSteemDisplay() {
   CRTBmpLineLength = 0;
   CRThwnd = NULL;
   CRTFullscreen = FullScreen;
-  CRTpixels = NULL;
-  CRTwidth = 0;
-  CRTheight = 0;
+  memset( CRTframe, 0, sizeof( CRTframe ) );
+  CRTwriteFrame = 0;
   CRTexit = 0;
   CRTviewy = 0;
   CRTvieww = 0;
@@ -465,6 +465,10 @@ TSteemDisplay::TSteemDisplay() {
 #ifndef NO_XVIDMODE
   XVM_Modes=NULL;
 #endif
+#ifdef STEEM_BENCH
+  NullBmpMem=NULL;
+  NullBmpLineLength=0;
+#endif
 #endif
   ScreenShotFormat=0;
   ScreenShotUseFullName=0;ScreenShotAlwaysAddNum=0;
@@ -666,6 +670,13 @@ HRESULT TSteemDisplay::Lock() {// SS called by draw_begin()
     draw_line_length=X_Img->bytes_per_line;
     derr=DD_OK;
     break;
+#endif
+#ifdef STEEM_BENCH
+  case DISPMETHOD_NULL:
+    draw_line_length=NullBmpLineLength;
+    draw_mem=NullBmpMem;
+    derr=DD_OK;
+    break;
 #endif
   }
   // compute locked video memory as pitch * #lines
@@ -757,6 +768,10 @@ void TSteemDisplay::Unlock() {
   case DISPMETHOD_X:
   case DISPMETHOD_XSHM:
     break;
+#endif
+#ifdef STEEM_BENCH
+  case DISPMETHOD_NULL:
+    break;
 #endif
   }//sw
 }
@@ -934,21 +949,9 @@ bool TSteemDisplay::Blit() {
 #ifdef STEEM_CRT
   case DISPMETHOD_CRT:
   {
-    if( !CRTpixels ) break;
-    thread_mutex_lock( &CRTmutex );
-    RECT dest;
-    GetClientRect(StemWin,&dest);
-
-    CRTviewy = ( FullScreen && runstate != RUNSTATE_RUNNING ) ? MENUHEIGHT / 2 : 0;
-    CRTvieww = dest.right - dest.left;
-    CRTviewh = dest.bottom - dest.top - ( ( FullScreen && runstate == RUNSTATE_RUNNING ) ? 0 : MENUHEIGHT );
-    if( FullScreen && runstate == RUNSTATE_RUNNING ) {
-        MoveWindow( CRThwnd, 0, 0, CRTvieww, CRTviewh, FALSE );
-        SetWindowLong( CRThwnd, GWL_STYLE, GetWindowLong( CRThwnd, GWL_STYLE ) & (~ WS_CLIPSIBLINGS ) ) ;  	
-    } else {
-        MoveWindow( CRThwnd, 0, MENUHEIGHT, CRTvieww, CRTviewh, FALSE );
-        SetWindowLong( CRThwnd, GWL_STYLE, GetWindowLong( CRThwnd, GWL_STYLE ) | WS_CLIPSIBLINGS ) ;  	
-    }
+    TCRTFrame* frame = &CRTframe[ CRTwriteFrame ];
+    if( !frame->pixels ) break;
+    CRTUpdateView();
 
     if( FullScreen && !CRTFullscreen ) {
         CRTFullscreen = FullScreen;
@@ -962,6 +965,7 @@ bool TSteemDisplay::Blit() {
 	int blit_width = draw_blit_source_rect.right-draw_blit_source_rect.left;
 	int blit_height =draw_blit_source_rect.bottom-draw_blit_source_rect.top;
 	CRTEMU_U32* srcpixels = (CRTEMU_U32*) CRTBmpMem;
+	CRTEMU_U32* CRTpixels = (CRTEMU_U32*) frame->pixels;
 
 	if( blit_width / blit_height < 2 ) {
 		for( int y = 0; y < blit_height; ++y ) {
@@ -988,9 +992,12 @@ bool TSteemDisplay::Blit() {
 		blit_height *= 2;
 	}
 
-    CRTwidth = blit_width;
-    CRTheight = blit_height;
-    thread_mutex_unlock( &CRTmutex );
+    frame->width = blit_width;
+    frame->height = blit_height;
+    // publish, we get back the buffer the CRT thread isn't reading
+    CRTwriteFrame = thread_atomic_int_swap( &CRTlatestFrame, CRTwriteFrame | CRT_FRAME_FRESH ) & CRT_FRAME_INDEX;
+    thread_signal_raise( &CRTframeSignal );
+    success=true;
     break;
   }
 #endif
@@ -1297,7 +1304,12 @@ void TSteemDisplay::RunStart(bool Temp) {
   // delete screen
   Lock(); // as in DDCreateSurfaces()...
   if(draw_mem)
+  {
     ZeroMemory(draw_mem,VideoMemorySize);
+#if defined(SSE_VID_LINE_CACHE)
+    ScanlineCache.Invalidate();
+#endif
+  }
   Unlock();
   //if(OPTION_FAKE_FULLSCREEN)
   {
@@ -1465,6 +1477,9 @@ void TSteemDisplay::ScreenChange() {
     VideoLock.Lock();
 #endif
   draw_end();
+#if defined(SSE_VID_LINE_CACHE)
+  ScanlineCache.Dirty=true; // new or resized host surface
+#endif
   TRACE_LOG("ScreenChange()\n");
   switch(Method) {
 #if defined(SSE_VID_D3D)
@@ -1508,6 +1523,11 @@ void TSteemDisplay::ScreenChange() {
     else
       Init();
     break;
+#endif
+#ifdef STEEM_BENCH
+  case DISPMETHOD_NULL:
+    InitNull();
+    break;
 #endif
   }//sw
 #if defined(SSE_EMU_THREAD)
@@ -1636,6 +1656,9 @@ HRESULT TSteemDisplay::RestoreSurfaces() {
         VSyncTiming=0;
 #endif
         TRACE_LOG("Restore surfaces %d\n",DErr);
+#if defined(SSE_VID_LINE_CACHE)
+        ScanlineCache.Invalidate();
+#endif
       }
     }
     break;
@@ -1698,6 +1721,9 @@ void TSteemDisplay::ChangeToFullScreen() {
     ) return;
   TRACE_LOG("Going fullscreen...\n");
   draw_end();
+#if defined(SSE_VID_LINE_CACHE)
+  ScanlineCache.Dirty=true; // the fullscreen window must get the picture
+#endif
 
 #ifdef STEEM_CRT
     CheckCurrentMonitorConfig();    
@@ -2095,6 +2121,9 @@ void TSteemDisplay::ChangeToWindowedMode(bool Emergency) {
     FullScreen==0) 
     return;
   TRACE_LOG("Going windowed mode...\n");
+#if defined(SSE_VID_LINE_CACHE)
+  ScanlineCache.Dirty=true; // the window must get the picture back
+#endif
 #ifdef WIN32
   if(FullScreen) 
     TScreenSaver::killTimer();
@@ -2194,11 +2223,12 @@ void TSteemDisplay::Release() {
 #ifdef STEEM_CRT
     if( CRTthread != NULL ) {
         CRTexit = 1;
+        thread_signal_raise( &CRTframeSignal );
         thread_join( CRTthread );
         thread_destroy( CRTthread );
 
-        thread_mutex_term( &CRTmutex );
         thread_signal_term( &CRTsignal );
+        thread_signal_term( &CRTframeSignal );
 
         CloseWindow( CRThwnd );
     }
@@ -2209,9 +2239,8 @@ void TSteemDisplay::Release() {
     CRTBmpLineLength = 0;
     CRThwnd = NULL;
     CRTFullscreen = FullScreen;
-    CRTpixels = NULL;
-    CRTwidth = 0;
-    CRTheight = 0;
+    memset( CRTframe, 0, sizeof( CRTframe ) );
+    CRTwriteFrame = 0;
     CRTexit = 0;
     CRTviewy = 0;
     CRTvieww = 0;
@@ -2270,6 +2299,13 @@ void TSteemDisplay::Release() {
     XSHM_Info.shmid=-1;
   }
 #endif
+#ifdef STEEM_BENCH
+  if(NullBmpMem)
+  {
+    delete[] NullBmpMem;
+    NullBmpMem=NULL;
+  }
+#endif
 #endif//ux
   palette_remove();
   Method=DISPMETHOD_NONE;
@@ -2666,7 +2702,12 @@ HRESULT TSteemDisplay::DDCreateSurfaces() {
   OurBackSur=DDBackSur;
   Lock();
   if(draw_mem)
+  {
     ZeroMemory(draw_mem,VideoMemorySize);
+#if defined(SSE_VID_LINE_CACHE)
+    ScanlineCache.Invalidate();
+#endif
+  }
   Unlock();
   draw_init_resdependent();
   palette_prepare(
@@ -2850,32 +2891,40 @@ int TSteemDisplay::CRTthreadProc() {
   if( !wglSwapIntervalEXT ) {
       frametimer_lock_rate( frametimer, 60 );
   }
-  CRTpixels = (CRTEMU_U32*) malloc( sizeof( CRTEMU_U32 ) * 1280 * 1024 );
-  CRTEMU_U32* CRTpixelsCopy = (CRTEMU_U32*) malloc( sizeof( CRTEMU_U32 ) * 1280 * 1024 );
-  int CRTwidthCopy = 0;
-  int CRTheightCopy = 0;
-  int CRTviewyCopy = 0;
-  int CRTviewwCopy = 0;
-  int CRTviewhCopy = 0;
+  for( int i = 0; i < 3; ++i ) {
+      CRTframe[ i ].pixels = (unsigned int*) malloc( sizeof( CRTEMU_U32 ) * 1280 * 1024 );
+      CRTframe[ i ].width = 0;
+      CRTframe[ i ].height = 0;
+  }
+  // Blit() writes buffer 0, 1 is in the middle, we read 2
+  CRTwriteFrame = 0;
+  thread_atomic_int_store( &CRTlatestFrame, 1 );
+  thread_atomic_int_store( &CRTviewChanged, 0 );
+  int CRTreadFrame = 2;
 
   thread_signal_raise( &CRTsignal );
   while( !CRTexit ) {  
-      thread_mutex_lock( &CRTmutex );
-      CRTwidthCopy = CRTwidth;
-      CRTheightCopy = CRTheight;
-      CRTviewyCopy = CRTviewy;
-      CRTviewwCopy = CRTvieww;
-      CRTviewhCopy = CRTviewh;
-      memcpy( CRTpixelsCopy, CRTpixels, CRTwidth * CRTheight * 4 );
-      thread_mutex_unlock( &CRTmutex );
+      bool fresh = ( thread_atomic_int_load( &CRTlatestFrame ) & CRT_FRAME_FRESH ) != 0;
+      if( fresh ) 
+          CRTreadFrame = thread_atomic_int_swap( &CRTlatestFrame, CRTreadFrame ) & CRT_FRAME_INDEX;
+      bool view_changed = thread_atomic_int_swap( &CRTviewChanged, 0 ) != 0;
+      if( !fresh && !view_changed ) {
+          // nothing new, don't present the same frame again
+          thread_signal_wait( &CRTframeSignal, 100 );
+          continue;
+      }
+      int viewy = CRTviewy;
+      int vieww = CRTvieww;
+      int viewh = CRTviewh;
+      TCRTFrame* frame = &CRTframe[ CRTreadFrame ];
   	
       frametimer_update( frametimer );
-      if( CRTviewwCopy > 0 && CRTviewhCopy > 0 ) { 
+      if( vieww > 0 && viewh > 0 ) { 
           QueryPerformanceCounter( &perfc );
           CRTEMU_U64 delta = perfc.QuadPart - CRTstart; 
           CRTEMU_U64 time_us = delta / ( perff.QuadPart / 1000000 );
-          crtemu->Viewport( 0, 0, CRTviewwCopy, CRTviewhCopy );    
-          crtemu_present( crtemu, time_us, (CRTEMU_U32*)CRTpixelsCopy, CRTwidthCopy, CRTheightCopy, 0xffffffff, 0xff181818, CRTviewy  );      
+          crtemu->Viewport( 0, 0, vieww, viewh );    
+          crtemu_present( crtemu, time_us, (CRTEMU_U32*)frame->pixels, frame->width, frame->height, 0xffffffff, 0xff181818, viewy  );      
           SwapBuffers( CRTdc );
           thread_signal_raise( &CRTsignal );
       }
@@ -2886,12 +2935,32 @@ int TSteemDisplay::CRTthreadProc() {
   wglDeleteContext( context );
   ReleaseDC( CRThwnd, CRTdc );
   FreeLibrary( dll );
-  free( CRTpixels );
-  free( CRTpixelsCopy );
-  CRTpixels = NULL;
+  for( int i = 0; i < 3; ++i ) {
+      free( CRTframe[ i ].pixels );
+      CRTframe[ i ].pixels = NULL;
+  }
   return 0;
 }
 
+
+void TSteemDisplay::CRTUpdateView() {
+    RECT dest;
+    GetClientRect(StemWin,&dest);
+
+    CRTviewy = ( FullScreen && runstate != RUNSTATE_RUNNING ) ? MENUHEIGHT / 2 : 0;
+    CRTvieww = dest.right - dest.left;
+    CRTviewh = dest.bottom - dest.top - ( ( FullScreen && runstate == RUNSTATE_RUNNING ) ? 0 : MENUHEIGHT );
+    if( FullScreen && runstate == RUNSTATE_RUNNING ) {
+        MoveWindow( CRThwnd, 0, 0, CRTvieww, CRTviewh, FALSE );
+        SetWindowLong( CRThwnd, GWL_STYLE, GetWindowLong( CRThwnd, GWL_STYLE ) & (~ WS_CLIPSIBLINGS ) ) ;  	
+    } else {
+        MoveWindow( CRThwnd, 0, MENUHEIGHT, CRTvieww, CRTviewh, FALSE );
+        SetWindowLong( CRThwnd, GWL_STYLE, GetWindowLong( CRThwnd, GWL_STYLE ) | WS_CLIPSIBLINGS ) ;  	
+    }
+    // after the values, the CRT thread reads them once it has cleared the flag
+    thread_atomic_int_store( &CRTviewChanged, 1 );
+}
+
 int TSteemDisplay::CRTthreadWrapper( void* user_data ) {
     TSteemDisplay* display = (TSteemDisplay*) user_data;
     return display->CRTthreadProc();
@@ -2934,8 +3003,8 @@ bool TSteemDisplay::InitCRT() { // SS generally Direct X is used instead
   RegisterClassEx( &wc );
   CRThwnd = CreateWindowEx( WS_EX_TRANSPARENT, wc.lpszClassName, 0, WS_CHILD | WS_CLIPSIBLINGS | WS_VISIBLE, 0, MENUHEIGHT+2, SurfaceWidth, SurfaceHeight - (MENUHEIGHT+2), StemWin, (HMENU) 0, GetModuleHandle( NULL ), 0 );
 
-  thread_mutex_init( &CRTmutex );
   thread_signal_init( &CRTsignal );
+  thread_signal_init( &CRTframeSignal );
   CRTexit = 0;
   CRTthread = thread_create( CRTthreadWrapper, this, THREAD_STACK_SIZE_DEFAULT );
   thread_signal_wait( &CRTsignal, THREAD_SIGNAL_WAIT_INFINITE );
@@ -3588,6 +3657,9 @@ void draw_init_resdependent() {
     delete[] osd_plasma_pal; osd_plasma_pal=NULL;
     delete[] osd_plasma;     osd_plasma=NULL;
   }
+#if defined(SSE_VID_LINE_CACHE)
+  ScanlineCache.Invalidate(); // new surface
+#endif
 }
 
 
@@ -4104,7 +4176,12 @@ HRESULT TSteemDisplay::D3DCreateSurfaces() {
     draw_mem=NULL;
     Lock();
     if(draw_mem)
+    {
       ZeroMemory(draw_mem,Disp.VideoMemorySize);
+#if defined(SSE_VID_LINE_CACHE)
+      ScanlineCache.Invalidate();
+#endif
+    }
     Unlock();
     draw_init_resdependent();
     palette_prepare(
@@ -4633,6 +4710,32 @@ bool TSteemDisplay::InitX()
   return true;
 }
 //---------------------------------------------------------------------------
+#ifdef STEEM_BENCH
+
+bool TSteemDisplay::InitNull() {
+/*  Headless benchmark: we draw into a 32bit host memory surface the size
+    of the largest border window, so the rendering code is exercised, but
+    blitting is a no-op.
+*/
+  Release();
+  int w=640+4*BORDER_SIDE,h=400+2*(BORDER_TOP+BORDER_BOTTOM);
+#if !defined(SSE_VID_32BIT_ONLY)
+  BytesPerPixel=4;
+#endif
+  rgb32_bluestart_bit=0;
+  NullBmpLineLength=4*w;
+  NullBmpMem=new BYTE[NullBmpLineLength*h+1];
+  ZeroMemory(NullBmpMem,NullBmpLineLength*h);
+  SurfaceWidth=w;
+  SurfaceHeight=h;
+  draw_init_resdependent();
+  palette_prepare(true);
+  Method=DISPMETHOD_NULL;
+  return true;
+}
+
+#endif
+//---------------------------------------------------------------------------
 #ifndef NO_SHM
 _XFUNCPROTOBEGIN
 int XShmGetEventBase(
@@ -4788,6 +4891,9 @@ int TSteemDisplay::XVM_WinProc(void*,Window Win,XEvent *Ev)
 #endif
   switch (Ev->type){
     case Expose:
+#if defined(SSE_VID_LINE_CACHE)
+      ScanlineCache.Dirty=true; // the next frame is blitted even if unchanged
+#endif
 #if SSE_VERSION>=370
       draw_grille_black=MAX((int)draw_grille_black,50);
 #else
@@ -33,6 +33,7 @@ PC display.
 #include <osd.h>
 #include <gui.h>
 #include <debug_framereport.h>
+#include <draw_threads.h>
 
 BYTE bad_drawing=0;
 BYTE border=0,border_last_chosen=0;
@@ -162,6 +163,9 @@ void draw_begin() {
   draw_dest_ad=draw_mem;
   draw_dest_next_scanline=draw_dest_ad+draw_dest_increase_y;
   WIN_ONLY( draw_store_dest_ad=NULL; )
+#if defined(SSE_VID_LINE_CACHE)
+  ScanlineCache.Frame();
+#endif
   if(SCANLINES_OK)
     draw_grille_black=4;
   if(draw_grille_black>0) 
@@ -196,6 +200,10 @@ void draw_begin() {
         memset(d,0,l); // black line
         d+=draw_dest_increase_y;
       }
+#if defined(SSE_VID_LINE_CACHE)
+      if(draw_med_low_double_height) // we erased half of the cached pixels
+        ScanlineCache.Invalidate();
+#endif
     }
     draw_grille_black--;
   }
@@ -203,6 +211,9 @@ void draw_begin() {
   if(x_draw_surround_count>0) {
     Disp.Surround();
     x_draw_surround_count--;
+#if defined(SSE_VID_LINE_CACHE)
+    ScanlineCache.Invalidate();
+#endif
   }
 #endif
 #ifdef DEBUG_BUILD
@@ -486,6 +497,9 @@ void draw_set_jumps_and_source() {
 #ifdef WIN32
   draw_buffer_complex_scanlines=((Disp.Method==DISPMETHOD_DD||Disp.Method
     ==DISPMETHOD_D3D)&&Disp.DrawToVidMem && draw_med_low_double_height);
+#endif
+#if defined(SSE_VID_DRAW_THREADS)
+  DrawThreads.Frame(); // may replace the routines
 #endif
   //TRACE("src %d %d %d %d len %d\n",draw_blit_source_rect.left,draw_blit_source_rect.top,draw_blit_source_rect.right,draw_blit_source_rect.bottom,draw_line_length);
   //TRACE_OSD("C%d B%d D%d SI%d",CanUse_400,big_draw,draw_med_low_double_height,SCANLINES_INTERPOLATED);
@@ -495,6 +509,10 @@ void draw_set_jumps_and_source() {
 void draw_end() {
   if(!draw_lock)
     return;
+#if defined(SSE_VID_DRAW_THREADS)
+  DrawThreads.Sync();
+  DrawThreads.Active=false;
+#endif
 #ifndef ONEGAME
   bool draw_osd=true;
   if(DoSaveScreenShot||slow_motion
@@ -505,7 +523,21 @@ void draw_end() {
     draw_osd=false;
 #endif
   if(draw_osd)
+  {
+#if defined(SSE_VID_LINE_CACHE)
+    // The OSD bumps draw_grille_black when it draws something, its pixels
+    // would stay on screen on cached lines.
+    BYTE grille_black=draw_grille_black;
+    draw_grille_black=0;
+    osd_draw();
+    if(draw_grille_black)
+      ScanlineCache.Invalidate();
+    if(draw_grille_black<grille_black)
+      draw_grille_black=grille_black;
+#else
     osd_draw();
+#endif
+  }
 #endif
 #ifdef DEBUG_BUILD
   Shifter.DrawBufferedScanlineToVideo(); 
@@ -518,6 +550,9 @@ void draw_end() {
   draw_scanline=draw_scanline_dont;
   WIN_ONLY( draw_store_dest_ad=NULL; )
   draw_lock=false;
+#if defined(SSE_VID_LINE_CACHE)
+  ScanlineCache.Active=false;
+#endif
   if(DoSaveScreenShot) 
   {
     Disp.SaveScreenShot();
@@ -540,6 +575,10 @@ bool draw_blit() {
       palette_flip();
 #endif
     ok=Disp.Blit();
+#if defined(SSE_VID_LINE_CACHE)
+    if(ok) // the host shows the buffer
+      ScanlineCache.Dirty=false;
+#endif
     // Check for screen change right after the blit so that we
     //  don't erase the frame (fullscreen) just before it's rendered
     if(runstate==RUNSTATE_RUNNING)
@@ -779,3 +818,354 @@ bool draw_routines_init() {
   osd_routines_init();
   return true;
 }
+
+
+#if defined(SSE_VID_LINE_CACHE)
+
+TScanlineCache ScanlineCache;
+
+
+inline DWORD line_cache_mix(DWORD hash,DWORD k) { // MurmurHash3 step
+  k*=0xcc9e2d51;
+  k=(k<<15)|(k>>17);
+  k*=0x1b873593;
+  hash^=k;
+  hash=(hash<<13)|(hash>>19);
+  return hash*5+0xe6546b64;
+}
+
+
+inline DWORD line_cache_fmix(DWORD hash) { // MurmurHash3 finalizer
+  hash^=hash>>16;
+  hash*=0x85ebca6b;
+  hash^=hash>>13;
+  hash*=0xc2b2ae35;
+  return hash^(hash>>16);
+}
+
+
+TScanlineCache::TScanlineCache() {
+  Enabled=true;
+  SkipUnchanged=false;
+  Active=false;
+  DrawMem=NULL;
+  LineLength=IncreaseY=0;
+  nHit=nMiss=nSkippedFrames=0;
+  Invalidate();
+}
+
+
+void TScanlineCache::Invalidate() {
+  for(int i=0;i<NLINES;i++)
+    Line[i].Valid=false;
+  Dirty=true;
+}
+
+
+void TScanlineCache::Invalidate(BYTE *from) {
+  if(!DrawMem||!LineLength)
+    return;
+  int i=(from<=DrawMem) ? 0 : (int)((from-DrawMem)/LineLength);
+  for(;i<NLINES;i++)
+  {
+    if(Line[i].Valid) // else those pixels are already cleared
+    {
+      Line[i].Valid=false;
+      Dirty=true;
+    }
+  }
+}
+
+
+void TScanlineCache::Frame() {
+/*  Called by draw_begin() once the buffer is locked. Cached pixels must
+    still be there, so the buffer must be the same as for the previous
+    frame. With DirectDraw flipping or triple buffering, we get another
+    surface each time, so there's no cache.
+*/
+  Active=(Enabled && !OPTION_C3 && !extended_monitor
+    && emudetect_falcon_mode==EMUD_FALC_MODE_OFF);
+#if defined(SSE_VID_DD)
+  if(Disp.Method==DISPMETHOD_DD && (FullScreen||OPTION_3BUFFER_WIN))
+    Active=false;
+#endif
+#ifdef DEBUG_BUILD
+  Active=false; // the debugger draws in the buffer
+#endif
+  if(!Active||draw_mem!=DrawMem||draw_line_length!=LineLength
+    ||draw_dest_increase_y!=IncreaseY)
+  {
+    Invalidate();
+    DrawMem=draw_mem;
+    LineLength=draw_line_length;
+    IncreaseY=draw_dest_increase_y;
+  }
+}
+
+
+bool TScanlineCache::Skip(int border1,int picture,int border2,int hscroll,
+                          bool whole_line) {
+/*  Called just before draw_scanline(). Returns true if the pixels at the
+    destination already are what the routine would draw.
+    The line is identified by its place in PC memory, not by scan_y, so
+    that a line that moves doesn't leave a wrong entry behind.
+*/
+  if(!Active||!(border1|picture|border2))
+    return false;
+  bool dirty=Dirty;
+  Dirty=true; // we draw, unless it's a hit
+  BYTE *dest=draw_dest_next_scanline-draw_dest_increase_y;
+  if(dest<DrawMem)
+    return false;
+  int i=(int)((dest-DrawMem)/LineLength);
+  if(i>=NLINES)
+    return false;
+  TLine &line=Line[i];
+  if(!whole_line) // part of a line with rasters: draw, forget
+  {
+    line.Valid=false;
+    return false;
+  }
+  // Bytes read by the routine, counting the extra raster for hscroll
+  int nbytes=(screen_res==2) ? picture*2 : ((picture+hscroll+15)>>4)*8+8;
+  MEM_ADDRESS source=shifter_draw_pointer&0xffffff;
+  if(source+nbytes>mem_len) // the routine will wrap
+  {
+    line.Valid=false;
+    return false;
+  }
+  // 64bit hash of video RAM, palette, shift mode and Glue tricks: two
+  // lanes with other seeds, the second one gets the words with their
+  // halves swapped
+  DWORD hash=(DWORD)screen_res^(Glue.CurrentScanline.Tricks<<2);
+  DWORD hash2=hash^0x9e3779b9;
+  const DWORD *p=(DWORD*)(Mem_End-(source+nbytes));
+  for(int n=nbytes/4;n>0;n--,p++)
+  {
+    hash=line_cache_mix(hash,*p);
+    hash2=line_cache_mix(hash2,(*p<<16)|(*p>>16));
+  }
+  for(int n=0;n<16;n++)
+  {
+    DWORD k=(DWORD)PCpal[n];
+    hash=line_cache_mix(hash,k);
+    hash2=line_cache_mix(hash2,(k<<16)|(k>>16));
+  }
+  hash=line_cache_fmix(hash);
+  hash2=line_cache_fmix(hash2);
+  if(line.Valid && line.Hash[0]==hash && line.Hash[1]==hash2
+    && line.Routine==draw_scanline
+    && line.Border1==border1 && line.Picture==picture
+    && line.Border2==border2 && line.Hscroll==hscroll)
+  {
+    Dirty=dirty;
+    nHit++;
+    return true;
+  }
+  line.Hash[0]=hash;
+  line.Hash[1]=hash2;
+  line.Routine=draw_scanline;
+  line.Border1=(short)border1;
+  line.Picture=(short)picture;
+  line.Border2=(short)border2;
+  line.Hscroll=(BYTE)hscroll;
+  line.Valid=true;
+  nMiss++;
+  return false;
+}
+
+
+
+bool TScanlineCache::SkipBlit() {
+/*  Called by the run loop after draw_end(). If no line was drawn and nothing
+    else touched the buffer since the last blit, the host already shows
+    this frame. draw_blit() also checks for resolution changes, so we
+    don't skip when one is pending.
+*/
+  if(!SkipUnchanged||Dirty||video_mixed_output
+    ||screen_res!=screen_res_at_start_of_vbl)
+    return false;
+  nSkippedFrames++;
+  return true;
+}
+
+#endif//SSE_VID_LINE_CACHE
+
+
+#if defined(SSE_VID_DRAW_C_SIMD)
+/*  SIMD inner loop of the 32bit renderers, for the full 16-pixel rasters (the
+    hscroll part and the remainder stay in C++). Used by draw_c and the draw
+    threads, which include the same templates.
+    Each plane word is broadcast and compared with one bit mask per pixel, the
+    results are or'ed into the 16 colour indices at once (4 planes low res,
+    2 med res, 1 high res).
+    SSE2 then reads the palette entries one by one (no 32bit shuffle on 16
+    entries before AVX2), AVX2 looks them up in two registers with vpermd.
+    A raster is stored in 64 bytes (128 doubled), on one or two lines.
+    The kernels are chosen at startup through CPUID, NULL = the C++ loops.
+*/
+
+#include <immintrin.h>
+
+// lane 0 = leftmost pixel = bit 15
+#define DRAW_C_INDEX_16_PIXELS(p,nplanes,ia,ib) {\
+  const __m128i mask_a=_mm_set_epi16(0x0100,0x0200,0x0400,0x0800,0x1000,\
+    0x2000,0x4000,(short)0x8000);\
+  const __m128i mask_b=_mm_set_epi16(0x01,0x02,0x04,0x08,0x10,0x20,0x40,\
+    0x80);\
+  ia=ib=_mm_setzero_si128();\
+  for(int k=0;k<nplanes;k++)\
+  {\
+    __m128i w=_mm_set1_epi16(*(const short*)(p-2*k));\
+    __m128i bit=_mm_set1_epi16((short)(1<<k));\
+    ia=_mm_or_si128(ia,_mm_and_si128(\
+      _mm_cmpeq_epi16(_mm_and_si128(w,mask_a),mask_a),bit));\
+    ib=_mm_or_si128(ib,_mm_and_si128(\
+      _mm_cmpeq_epi16(_mm_and_si128(w,mask_b),mask_b),bit));\
+  }\
+}
+
+
+inline BYTE* draw_c_store_4_pixels(BYTE *dest,__m128i px,int line_length,
+                                   int width,bool two_lines) {
+  if(width==2)
+  {
+    __m128i lo=_mm_unpacklo_epi32(px,px),hi=_mm_unpackhi_epi32(px,px);
+    _mm_storeu_si128((__m128i*)dest,lo);
+    _mm_storeu_si128((__m128i*)(dest+16),hi);
+    if(two_lines)
+    {
+      _mm_storeu_si128((__m128i*)(dest+line_length),lo);
+      _mm_storeu_si128((__m128i*)(dest+line_length+16),hi);
+    }
+    return dest+32;
+  }
+  _mm_storeu_si128((__m128i*)dest,px);
+  if(two_lines)
+    _mm_storeu_si128((__m128i*)(dest+line_length),px);
+  return dest+16;
+}
+
+
+BYTE* draw_c_blocks_sse2(const BYTE *source,int nblocks,int nplanes,
+                         const DWORD *pal,BYTE *dest,int line_length,
+                         int width,bool two_lines) {
+  BYTE index[16];
+  for(;nblocks>0;nblocks--,source-=nplanes*2)
+  {
+    __m128i ia,ib;
+    DRAW_C_INDEX_16_PIXELS(source,nplanes,ia,ib)
+    _mm_storeu_si128((__m128i*)index,_mm_packus_epi16(ia,ib));
+    for(int i=0;i<16;i+=4)
+      dest=draw_c_store_4_pixels(dest,_mm_set_epi32(pal[index[i+3]],
+        pal[index[i+2]],pal[index[i+1]],pal[index[i]]),line_length,width,
+        two_lines);
+  }
+  return dest;
+}
+
+
+#if _MSC_VER>=1700 // VS2012, AVX2 intrinsics
+
+inline BYTE* draw_c_store_8_pixels(BYTE *dest,__m256i px,int line_length,
+                                   int width,bool two_lines) {
+  if(width==2)
+  {
+    // unpack works within 128bit lanes: p0p0p1p1 p4p4p5p5 ...
+    __m256i lo=_mm256_unpacklo_epi32(px,px),hi=_mm256_unpackhi_epi32(px,px);
+    __m256i q0=_mm256_permute2x128_si256(lo,hi,0x20);
+    __m256i q1=_mm256_permute2x128_si256(lo,hi,0x31);
+    _mm256_storeu_si256((__m256i*)dest,q0);
+    _mm256_storeu_si256((__m256i*)(dest+32),q1);
+    if(two_lines)
+    {
+      _mm256_storeu_si256((__m256i*)(dest+line_length),q0);
+      _mm256_storeu_si256((__m256i*)(dest+line_length+32),q1);
+    }
+    return dest+64;
+  }
+  _mm256_storeu_si256((__m256i*)dest,px);
+  if(two_lines)
+    _mm256_storeu_si256((__m256i*)(dest+line_length),px);
+  return dest+32;
+}
+
+
+BYTE* draw_c_blocks_avx2(const BYTE *source,int nblocks,int nplanes,
+                         const DWORD *pal,BYTE *dest,int line_length,
+                         int width,bool two_lines) {
+  const __m256i mask_a=_mm256_set_epi32(0x0100,0x0200,0x0400,0x0800,0x1000,
+    0x2000,0x4000,0x8000);
+  const __m256i mask_b=_mm256_set_epi32(0x01,0x02,0x04,0x08,0x10,0x20,0x40,
+    0x80);
+  // pal must hold 8 entries, 16 in low res
+  const __m256i pal_lo=_mm256_loadu_si256((const __m256i*)pal);
+  const __m256i pal_hi=(nplanes==4)
+    ? _mm256_loadu_si256((const __m256i*)(pal+8)) : pal_lo;
+  for(;nblocks>0;nblocks--,source-=nplanes*2)
+  {
+    __m256i ia=_mm256_setzero_si256(),ib=_mm256_setzero_si256();
+    for(int k=0;k<nplanes;k++)
+    {
+      __m256i w=_mm256_set1_epi32(*(const WORD*)(source-2*k));
+      __m256i bit=_mm256_set1_epi32(1<<k);
+      ia=_mm256_or_si256(ia,_mm256_and_si256(
+        _mm256_cmpeq_epi32(_mm256_and_si256(w,mask_a),mask_a),bit));
+      ib=_mm256_or_si256(ib,_mm256_and_si256(
+        _mm256_cmpeq_epi32(_mm256_and_si256(w,mask_b),mask_b),bit));
+    }
+    // vpermd uses bits 0-2 of the index, bit 3 (moved to the sign) selects
+    // the register
+    __m256i pa=_mm256_castps_si256(_mm256_blendv_ps(
+      _mm256_castsi256_ps(_mm256_permutevar8x32_epi32(pal_lo,ia)),
+      _mm256_castsi256_ps(_mm256_permutevar8x32_epi32(pal_hi,ia)),
+      _mm256_castsi256_ps(_mm256_slli_epi32(ia,28))));
+    __m256i pb=_mm256_castps_si256(_mm256_blendv_ps(
+      _mm256_castsi256_ps(_mm256_permutevar8x32_epi32(pal_lo,ib)),
+      _mm256_castsi256_ps(_mm256_permutevar8x32_epi32(pal_hi,ib)),
+      _mm256_castsi256_ps(_mm256_slli_epi32(ib,28))));
+    dest=draw_c_store_8_pixels(dest,pa,line_length,width,two_lines);
+    dest=draw_c_store_8_pixels(dest,pb,line_length,width,two_lines);
+  }
+  _mm256_zeroupper();
+  return dest;
+}
+
+
+static bool draw_c_has_avx2() {
+  int info[4];
+  __cpuid(info,0);
+  int max_leaf=info[0];
+  __cpuid(info,1);
+  // AVX2 also needs the OS to save the YMM registers (OSXSAVE, XCR0)
+  if(max_leaf>=7 && (info[2]&BIT_27) && (info[2]&BIT_28)
+    && ((_xgetbv(0)&6)==6))
+  {
+    __cpuidex(info,7,0);
+    return ((info[1]&BIT_5)!=0);
+  }
+  return false;
+}
+
+#endif//VS2012
+
+
+static bool draw_c_has_sse2() {
+  int info[4];
+  __cpuid(info,1);
+  return ((info[3]&BIT_26)!=0);
+}
+
+
+LPDRAWCBLOCKSPROC draw_c_blocks_select() {
+#if _MSC_VER>=1700
+  if(draw_c_has_avx2())
+    return draw_c_blocks_avx2;
+#endif
+  return (draw_c_has_sse2()) ? draw_c_blocks_sse2 : NULL;
+}
+
+
+LPDRAWCBLOCKSPROC draw_c_blocks=draw_c_blocks_select();
+
+#endif//SSE_VID_DRAW_C_SIMD
@@ -0,0 +1,457 @@
+/*---------------------------------------------------------------------------
+PROJECT: Steem SSE
+Atari ST emulator
+Copyright (C) 2020 by Anthony Hayward and Russel Hayward + SSE
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see https://www.gnu.org/licenses/.
+
+DOMAIN: Rendering
+FILE: draw_threads.cpp
+DESCRIPTION: Scanline conversion threads. In 32bit, the scanline routines
+called by the Shifter (Render(), DrawScanlineToEnd()) are replaced by
+routines that only record the call: the video RAM the line will read, the
+palette and the destination. The Shifter still decides when and what to
+draw, with the same timing, so only the production of pixels moves.
+Commands go by batches to a pool of worker threads (thread.h), one queue
+per worker, and are converted while the CPU emulates the next lines.
+draw_end() waits for the workers before the OSD and the blit.
+Writes to a part of the frame that was already recorded (the Shifter
+going back) wait for the workers too, so the order of writes doesn't
+change.
+The conversion uses the draw_c templates, on the copy.
+struct TDrawThreads
+---------------------------------------------------------------------------*/
+
+#include "pch.h"
+#pragma hdrstop
+
+#if defined(SSE_VID_DRAW_THREADS)
+
+#include <computer.h>
+#include <draw.h>
+#include <draw_threads.h>
+
+TDrawThreads DrawThreads;
+
+static void ASMCALL draw_scanline_record_lowres(int,int,int,int);
+static void ASMCALL draw_scanline_record_lowres_dw(int,int,int,int);
+static void ASMCALL draw_scanline_record_lowres_400(int,int,int,int);
+static void ASMCALL draw_scanline_record_medres(int,int,int,int);
+static void ASMCALL draw_scanline_record_medres_400(int,int,int,int);
+static void ASMCALL draw_scanline_record_hires(int,int,int,int);
+
+
+TDrawThreads::TDrawThreads() {
+  Command=NULL;
+  HighWater=NULL;
+  nConverted=nSync=nDirect=0;
+  nCommands=nBatches=BatchStart=NextWorker=0;
+  nThreads=0;
+  Threads=0;
+  Active=false;
+}
+
+
+TDrawThreads::~TDrawThreads() {
+  Stop();
+  delete[] Command;
+}
+
+
+bool TDrawThreads::Start(int nthreads) {
+  if(nThreads)
+    return false;
+  if(nthreads>MAX_THREADS)
+    nthreads=MAX_THREADS;
+  if(!Command) // allocated when first used
+    Command=new TDrawCommand[NCOMMANDS];
+  thread_atomic_int_store(&nBusy,0);
+  thread_signal_init(&Done);
+  for(int i=0;i<nthreads;i++)
+  {
+    TWorker &w=Worker[i];
+    w.Pool=this;
+    thread_queue_init(&w.Queue,NBATCHES+1,w.Values,0); // +1 for the end mark
+    w.Thread=thread_create(WorkerThread,&w,THREAD_STACK_SIZE_DEFAULT);
+    if(!w.Thread)
+    {
+      thread_queue_term(&w.Queue);
+      break;
+    }
+    nThreads++;
+  }
+  if(!nThreads)
+    thread_signal_term(&Done);
+  nCommands=nBatches=BatchStart=NextWorker=0;
+  HighWater=NULL;
+  return (nThreads!=0);
+}
+
+
+void TDrawThreads::Stop() {
+  if(!nThreads)
+    return;
+  Sync();
+  for(int i=0;i<nThreads;i++)
+  {
+    TWorker &w=Worker[i];
+    thread_queue_produce(&w.Queue,NULL); // end mark
+    thread_join(w.Thread);
+    thread_destroy(w.Thread);
+    thread_queue_term(&w.Queue);
+  }
+  thread_signal_term(&Done);
+  nThreads=0;
+  Active=false;
+}
+
+
+static const LPPIXELWISESCANPROC draw_32_routine[NDRAW32_ROUTINES]={
+  draw_scanline_32_lowres_pixelwise,draw_scanline_32_lowres_pixelwise_dw,
+  draw_scanline_32_lowres_pixelwise_400,draw_scanline_32_medres_pixelwise,
+  draw_scanline_32_medres_pixelwise_400,draw_scanline_32_hires};
+
+
+// In the order of draw_32_routine
+static const LPPIXELWISESCANPROC draw_scanline_record[NDRAW32_ROUTINES]={
+  draw_scanline_record_lowres,draw_scanline_record_lowres_dw,
+  draw_scanline_record_lowres_400,draw_scanline_record_medres,
+  draw_scanline_record_medres_400,draw_scanline_record_hires};
+
+
+static bool draw_32_replace(const LPPIXELWISESCANPROC *replacement) {
+/*  Returns false if the 32bit routines can't be replaced this frame.
+    Otherwise the current routines found in draw_32_routine are replaced,
+    other routines (Falcon, 'dont', already replaced...) are kept.
+*/
+  if(BytesPerPixel!=4 || OPTION_C3 || extended_monitor
+    || emudetect_falcon_mode!=EMUD_FALC_MODE_OFF)
+    return false;
+#ifdef WIN32
+  if(draw_buffer_complex_scanlines) // routines draw in draw_temp_line_buf
+    return false;
+#endif
+#ifdef DEBUG_BUILD
+  return false; // the debugger shows the frame being drawn
+#else
+  LPPIXELWISESCANPROC *current[3]={&draw_scanline,&draw_scanline_lowres,
+    &draw_scanline_medres};
+  for(int i=0;i<3;i++)
+  {
+    for(int j=0;j<NDRAW32_ROUTINES;j++)
+    {
+      if(*current[i]==draw_32_routine[j])
+      {
+        *current[i]=replacement[j];
+        break;
+      }
+    }
+  }
+  return true;
+#endif
+}
+
+
+void TDrawThreads::Frame() {
+/*  Called by draw_set_jumps_and_source(), at the start of each frame or
+    when the resolution changes. Commands recorded with the former
+    routines are converted first.
+*/
+  Sync();
+  if(!draw_lock)
+    return;
+  if(Threads!=nThreads)
+  {
+    Stop();
+    if(Threads)
+      Start(Threads);
+  }
+  Active=(nThreads && draw_32_replace(draw_scanline_record));
+}
+
+
+void TDrawThreads::Record(int routine,int border1,int picture,int border2,
+                          int hscroll,int nbytes_out) {
+/*  Called by the recording routines instead of the 32bit routine. We copy
+    what the routine would read and move draw_dest_ad as it would.
+*/
+  int increase=160,nbytes;
+  if(routine==DRAW32_HIRES)
+  {
+    increase=80;
+    nbytes=picture*2;
+  }
+  else if(routine==DRAW32_MEDRES||routine==DRAW32_MEDRES_400)
+    nbytes=((picture*2+hscroll+15)>>4)*4+4;
+  else // counting the extra raster for hscroll
+    nbytes=((picture+hscroll+15)>>4)*8+8;
+  MEM_ADDRESS source=shifter_draw_pointer&0xffffff;
+  while(source+increase>mem_len)
+    source-=increase;
+  if(nCommands==NCOMMANDS||draw_dest_ad<HighWater)
+    Sync();
+  if(nbytes>TDrawCommand::MAX_DATA||source+nbytes>mem_len)
+  {
+    Sync(); // draw now, in order
+    draw_32_routine[routine](border1,picture,border2,hscroll);
+    nDirect++;
+    return;
+  }
+  TDrawCommand &cmd=Command[nCommands++];
+  cmd.Routine=(BYTE)routine;
+  cmd.Dest=draw_dest_ad;
+  memcpy(cmd.Pal,PCpal,sizeof(cmd.Pal));
+  cmd.LineLength=draw_line_length;
+  cmd.Border1=(short)border1;
+  cmd.Picture=(short)picture;
+  cmd.Border2=(short)border2;
+  cmd.nData=(short)nbytes;
+  cmd.Hscroll=(BYTE)hscroll;
+  cmd.Inverted=(BYTE)(STpal[0]&1);
+  memcpy(cmd.Data,Mem_End-(source+nbytes),nbytes);
+  draw_dest_ad+=nbytes_out;
+  HighWater=draw_dest_ad;
+  if(nCommands-BatchStart==BATCH_SIZE)
+    Submit();
+}
+
+
+void TDrawThreads::Submit() {
+  // Commands since the last batch go to the next worker
+  if(nCommands==BatchStart)
+    return;
+  TDrawBatch &batch=Batch[nBatches++];
+  batch.First=BatchStart;
+  batch.Count=nCommands-BatchStart;
+  BatchStart=nCommands;
+  thread_atomic_int_inc(&nBusy);
+  thread_queue_produce(&Worker[NextWorker].Queue,&batch);
+  if(++NextWorker==nThreads)
+    NextWorker=0;
+}
+
+
+void TDrawThreads::Sync() {
+/*  Waits until all recorded commands are converted, then the buffers
+    can be used again.
+*/
+  if(!nThreads||!nCommands)
+    return;
+  Submit();
+  while(thread_atomic_int_load(&nBusy))
+    thread_signal_wait(&Done,THREAD_SIGNAL_WAIT_INFINITE);
+  nConverted+=nCommands;
+  nSync++;
+  nCommands=nBatches=BatchStart=0;
+  HighWater=NULL;
+}
+
+
+int TDrawThreads::WorkerThread(void *p) {
+  TWorker *w=(TWorker*)p;
+  TDrawThreads *pool=w->Pool;
+  for(;;)
+  {
+    TDrawBatch *batch=(TDrawBatch*)thread_queue_consume(&w->Queue);
+    if(!batch)
+      break;
+    const TDrawCommand *cmd=pool->Command+batch->First;
+    for(int n=batch->Count;n>0;n--)
+      Convert(*cmd++);
+    if(thread_atomic_int_dec(&pool->nBusy)==1) // was the last one
+      thread_signal_raise(&pool->Done);
+  }
+  return 0;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+// Conversion, using the templates of draw_c.cpp on the copy                //
+/////////////////////////////////////////////////////////////////////////////
+
+// The copy starts at the first word the routine reads
+#define GET_START(doubleflag,increase)  \
+  source=0;
+
+#define GET_SCREEN_DATA_INTO_REGS_AND_INC_SA {\
+  for(int i=0;i<4;i++,source+=2)\
+    w[i]=*(WORD*)(data_end_minus_2-source);\
+}
+
+#define GET_SCREEN_DATA_INTO_REGS_AND_INC_SA_MEDRES \
+  w0=*(WORD*)(data_end_minus_2-source);w1=*(WORD*)(data_end_minus_2-source-2); \
+  source+=4;
+
+#define GET_SCREEN_DATA_INTO_REGS_AND_INC_SA_HIRES \
+  w0=*(WORD*)(data_end_minus_2-source);      \
+  source+=2;
+
+#define CALC_COL_LOWRES_AND_DRAWPIXEL(mask) { \
+  int nibble= ((w[0]&mask)!=0) + (((w[1]&mask)!=0)<<1) + (((w[2]&mask)!=0)<<2) + (((w[3]&mask)!=0)<<3); \
+  DRAWPIXEL(PCpal[nibble])\
+}
+
+#define CALC_COL_MEDRES_AND_DRAWPIXEL(mask)   { \
+  int nibble= ((w0&mask)!=0) + (((w1&mask)!=0)<<1) ; \
+  DRAWPIXEL(PCpal[nibble])\
+}
+
+#define CALC_COL_HIRES_AND_DRAWPIXEL(mask) DRAWPIXEL((w0&mask)?fore:back)
+
+#define DRAW_BORDER_PIXELS(npixels) \
+  for(int i=npixels;i;i--) \
+  { \
+    DRAWPIXEL(border_col);\
+  }
+
+#if defined(SSE_VID_DRAW_C_SIMD)
+// Full rasters by the SSE2/AVX2 kernels of draw.cpp, on the copy
+#define DRAW_C_BLOCKS(nblocks,nplanes,pal) \
+  dest=(DWORD*)draw_c_blocks(data_end_minus_2-source,nblocks,nplanes,pal, \
+    (BYTE*)dest,cmd.LineLength,DRAW_C_SIMD_LAYOUT);
+#endif
+
+// The templates read PCpal, we use the copy
+#define CONVERT_BEGIN(border_colour) \
+  int border1=cmd.Border1,picture=cmd.Picture,border2=cmd.Border2; \
+  int hscroll=cmd.Hscroll; \
+  const DWORD *PCpal=cmd.Pal; \
+  const BYTE *data_end_minus_2=cmd.Data+cmd.nData-2; \
+  DWORD *dest=(DWORD*)cmd.Dest; \
+  int ll=cmd.LineLength/4; \
+  DWORD border_col=(border_colour); \
+  (void)hscroll;(void)PCpal;(void)ll;
+
+#define DRAWPIXEL(c) *(dest++)=(c);
+#if defined(SSE_VID_DRAW_C_SIMD)
+#define DRAW_C_SIMD_LAYOUT 1,false // width, two lines
+#endif
+
+static void convert_lowres(const TDrawCommand &cmd) {
+  CONVERT_BEGIN(cmd.Pal[0])
+#include "code/draw_c/draw_c_lowres_scanline.cpp"
+}
+
+static void convert_medres(const TDrawCommand &cmd) {
+  CONVERT_BEGIN(cmd.Pal[0])
+  border1*=2;border2*=2;
+#include "code/draw_c/draw_c_medres_scanline.cpp"
+}
+
+static void convert_hires(const TDrawCommand &cmd) {
+  CONVERT_BEGIN(0) // "In monochrome mode the border color is always black."
+  WORD STpal[1]; // the template reads STpal[0], we use the copy
+  STpal[0]=cmd.Inverted;
+#include "code/draw_c/draw_c_hires_scanline.cpp"
+}
+
+#undef DRAWPIXEL
+#undef DRAW_C_SIMD_LAYOUT
+#define DRAWPIXEL(c) {DWORD col=(c);dest[0]=dest[1]=col;dest+=2;}
+#if defined(SSE_VID_DRAW_C_SIMD)
+#define DRAW_C_SIMD_LAYOUT 2,false
+#endif
+
+static void convert_lowres_dw(const TDrawCommand &cmd) {
+  CONVERT_BEGIN(cmd.Pal[0])
+#include "code/draw_c/draw_c_lowres_scanline.cpp"
+}
+
+#undef DRAWPIXEL
+#undef DRAW_C_SIMD_LAYOUT
+#define DRAWPIXEL(c) {DWORD col=(c);dest[0]=dest[1]=dest[ll]=dest[ll+1]=col; \
+  dest+=2;}
+#if defined(SSE_VID_DRAW_C_SIMD)
+#define DRAW_C_SIMD_LAYOUT 2,true
+#endif
+
+static void convert_lowres_400(const TDrawCommand &cmd) {
+  CONVERT_BEGIN(cmd.Pal[0])
+#include "code/draw_c/draw_c_lowres_scanline.cpp"
+}
+
+#undef DRAWPIXEL
+#undef DRAW_C_SIMD_LAYOUT
+#define DRAWPIXEL(c) {DWORD col=(c);dest[0]=dest[ll]=col;dest++;}
+#if defined(SSE_VID_DRAW_C_SIMD)
+#define DRAW_C_SIMD_LAYOUT 1,true
+#endif
+
+// The 32bit routine draws the borders with 2 pixel wide units, so do we
+static void convert_medres_400(const TDrawCommand &cmd) {
+  CONVERT_BEGIN(cmd.Pal[0])
+  border1*=2;border2*=2;
+#include "code/draw_c/draw_c_medres_scanline.cpp"
+}
+
+#undef DRAWPIXEL
+#undef DRAW_C_SIMD_LAYOUT
+
+// In the order of draw_32_routine
+static void (*const convert_routine[NDRAW32_ROUTINES])(const TDrawCommand&)={
+  convert_lowres,convert_lowres_dw,convert_lowres_400,convert_medres,
+  convert_medres_400,convert_hires};
+
+
+void TDrawThreads::Convert(const TDrawCommand &cmd) {
+  convert_routine[cmd.Routine](cmd);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+// Recording routines, same parameters as the 32bit routines               //
+/////////////////////////////////////////////////////////////////////////////
+
+static void ASMCALL draw_scanline_record_lowres(int border1,int picture,
+                                                int border2,int hscroll) {
+  DrawThreads.Record(DRAW32_LOWRES,border1,picture,
+    border2,hscroll,(border1+picture+border2)*4);
+}
+
+
+static void ASMCALL draw_scanline_record_lowres_dw(int border1,int picture,
+                                                   int border2,int hscroll) {
+  DrawThreads.Record(DRAW32_LOWRES_DW,border1,picture,
+    border2,hscroll,(border1+picture+border2)*8);
+}
+
+
+static void ASMCALL draw_scanline_record_lowres_400(int border1,int picture,
+                                                    int border2,int hscroll) {
+  DrawThreads.Record(DRAW32_LOWRES_400,border1,picture,
+    border2,hscroll,(border1+picture+border2)*8);
+}
+
+
+static void ASMCALL draw_scanline_record_medres(int border1,int picture,
+                                                int border2,int hscroll) {
+  DrawThreads.Record(DRAW32_MEDRES,border1,picture,
+    border2,hscroll,(border1+picture+border2)*8);
+}
+
+
+static void ASMCALL draw_scanline_record_medres_400(int border1,int picture,
+                                                    int border2,int hscroll) {
+  DrawThreads.Record(DRAW32_MEDRES_400,border1,picture,
+    border2,hscroll,(border1+picture+border2)*8);
+}
+
+
+static void ASMCALL draw_scanline_record_hires(int border1,int picture,
+                                               int border2,int hscroll) {
+  DrawThreads.Record(DRAW32_HIRES,border1,picture,border2,hscroll,
+    (border1+picture+border2)*64);
+}
+
+#endif//SSE_VID_DRAW_THREADS
@@ -931,6 +931,24 @@ PRICV "%s",
     if(nMicrowire)
       fprintf(fp,"%sMicrowire: " PRICV " (TOS: " PRICV ")%s",sSte,nMicrowire,
         nMicrowireT,nl);
+#if defined(SSE_SOUND_ADAPTIVE_LATENCY)
+    if(SoundTarget && sound_freq)
+      fprintf(fp,"Latency: %dms (fill %dms, min %dms, jitter %dms)"
+        " underruns: " PRICV "%s",SoundTarget*1000/sound_freq,
+        SoundFill*1000/sound_freq,SoundFillMin*1000/sound_freq,
+        SoundJitter*1000/sound_freq,nSoundUnderrun,nl);
+#endif
+#if defined(SSE_SOUND_DRC)
+    if(SoundDrcPpm)
+      fprintf(fp,"Rate control: %+dppm%s",SoundDrcPpm,nl);
+#endif
+#if defined(SSE_SOUND_PROFILE)
+    if(SoundProfile.Mode)
+      fprintf(fp,"Sound profile (us/s): PSG %d antialias %d microwire %d"
+        " mix %d device %d, latency %dus to device, %dus to output%s",
+        SoundStageUs[0],SoundStageUs[1],SoundStageUs[2],SoundStageUs[3],
+        SoundStageUs[4],SoundProbeDeviceUs,SoundProbeOutputUs,nl);
+#endif
 #if defined(SSE_STATS_RTF)
     fprintf(fp,"\\b I/O\\b0 %s",nl);
 #else
@@ -0,0 +1,529 @@
+/*---------------------------------------------------------------------------
+PROJECT: Steem SSE
+Atari ST emulator
+Copyright (C) 2020 by Anthony Hayward and Russel Hayward + SSE
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see https://www.gnu.org/licenses/.
+
+DOMAIN: Sound
+FILE: flac.cpp
+DESCRIPTION: A small FLAC encoder for sound recording, so that hours of
+chiptunes don't make huge WAV files. It writes standard FLAC files (any
+player or 'flac -d' reads them) with a subset of the format:
+fixed blocks of 4096 samples, for each channel the smallest of constant,
+verbatim, fixed predictor (order 0-4) and LPC (order 1-8, 12bit
+coefficients), residuals Rice coded with partitions, stereo decorrelation
+(left/side, right/side, mid/side). No MD5.
+It runs on the recording thread, see sound_record.cpp.
+struct TFlacBits, TFlacEncoder
+---------------------------------------------------------------------------*/
+
+#include "pch.h"
+#pragma hdrstop
+
+#if defined(SSE_SOUND_RECORD_THREAD)
+
+#include <math.h>
+#include <limits.h>
+#include <flac.h>
+
+
+static BYTE flac_crc8(const BYTE *p,int n) { // polynomial x^8+x^2+x+1
+  BYTE crc=0;
+  while(n--)
+  {
+    crc^=*p++;
+    for(int i=0;i<8;i++)
+      crc=(crc&0x80) ? (BYTE)((crc<<1)^0x07) : (BYTE)(crc<<1);
+  }
+  return crc;
+}
+
+
+static WORD flac_crc16(const BYTE *p,int n) { // x^16+x^15+x^2+1
+  WORD crc=0;
+  while(n--)
+  {
+    crc^=(WORD)(*p++<<8);
+    for(int i=0;i<8;i++)
+      crc=(crc&0x8000) ? (WORD)((crc<<1)^0x8005) : (WORD)(crc<<1);
+  }
+  return crc;
+}
+
+
+static inline DWORD flac_fold(int r) { // signed residual -> Rice value
+  return (r<0) ? (DWORD)(-2*(long long)r-1) : (DWORD)(2*(long long)r);
+}
+
+
+void TFlacBits::Put(DWORD Value,int Bits) {
+  if(!Bits)
+    return;
+  if(Bits<32)
+    Value&=(1u<<Bits)-1;
+  Acc=(Acc<<Bits)|Value;
+  nBits+=Bits;
+  while(nBits>=8)
+  {
+    nBits-=8;
+    Buf[nBytes++]=(BYTE)(Acc>>nBits);
+  }
+}
+
+
+void TFlacBits::PutRice(DWORD Value,int Param) {
+  DWORD q=Value>>Param; // unary: q zeros then a one
+  while(q>=32)
+  {
+    Put(0,32);
+    q-=32;
+  }
+  Put(1,q+1);
+  Put(Value,Param);
+}
+
+
+TFlacEncoder::TFlacEncoder() {
+  for(int ch=0;ch<NCHANNELS;ch++)
+  {
+    Samples[ch]=new int[BLOCK_SIZE];
+    Residual[ch][0]=new int[BLOCK_SIZE];
+    Residual[ch][1]=new int[BLOCK_SIZE];
+  }
+  Windowed=new double[BLOCK_SIZE];
+  // a frame is never bigger than verbatim
+  Out.Buf=new BYTE[BLOCK_SIZE*NCHANNELS*sizeof(int)];
+  File=NULL;
+}
+
+
+TFlacEncoder::~TFlacEncoder() {
+  for(int ch=0;ch<NCHANNELS;ch++)
+  {
+    delete[] Samples[ch];
+    delete[] Residual[ch][0];
+    delete[] Residual[ch][1];
+  }
+  delete[] Windowed;
+  delete[] Out.Buf;
+}
+
+
+bool TFlacEncoder::Open(FILE *f,int freq,int channels,int bits) {
+  File=f;
+  Freq=freq;
+  nChannels=channels;
+  BitsPerSample=bits;
+  BytesPerFrame=channels*bits/8;
+  nSamples=nPartial=0;
+  FrameNumber=0;
+  TotalSamples=0;
+  MinFrameBytes=0xFFFFFF;
+  MaxFrameBytes=0;
+  fwrite("fLaC",1,4,File);
+  StreamInfoPos=ftell(File);
+  WriteStreamInfo(); // again at Close()
+  return (ferror(File)==0);
+}
+
+
+void TFlacEncoder::WriteStreamInfo() {
+  Out.nBytes=Out.nBits=0;
+  Out.Put(0x80,8); // last metadata block, STREAMINFO
+  Out.Put(34,24);
+  Out.Put(BLOCK_SIZE,16); // min, max block size
+  Out.Put(BLOCK_SIZE,16);
+  Out.Put(MaxFrameBytes ? MinFrameBytes : 0,24); // 0 = unknown
+  Out.Put(MaxFrameBytes,24);
+  Out.Put(Freq,20);
+  Out.Put(nChannels-1,3);
+  Out.Put(BitsPerSample-1,5);
+  Out.Put((DWORD)(TotalSamples>>32),4);
+  Out.Put((DWORD)TotalSamples,32);
+  for(int i=0;i<4;i++)
+    Out.Put(0,32); // no MD5
+  fwrite(Out.Buf,1,Out.nBytes,File);
+}
+
+
+void TFlacEncoder::PutSampleFrame(const BYTE *p) {
+  for(int ch=0;ch<nChannels;ch++)
+  {
+    if(BitsPerSample==8)
+      Samples[ch][nSamples]=p[ch]-128; // WAV 8bit is unsigned
+    else
+      Samples[ch][nSamples]=(short)(p[ch*2]|(p[ch*2+1]<<8));
+  }
+  if(++nSamples==BLOCK_SIZE)
+    EncodeFrame();
+}
+
+
+void TFlacEncoder::Write(const BYTE *Pcm,int Bytes) {
+  while(Bytes>0)
+  {
+    if(nPartial || Bytes<BytesPerFrame)
+    {
+      Partial[nPartial++]=*Pcm++;
+      Bytes--;
+      if(nPartial==BytesPerFrame)
+      {
+        PutSampleFrame(Partial);
+        nPartial=0;
+      }
+    }
+    else
+    {
+      PutSampleFrame(Pcm);
+      Pcm+=BytesPerFrame;
+      Bytes-=BytesPerFrame;
+    }
+  }
+}
+
+
+void TFlacEncoder::Close() {
+  if(!File)
+    return;
+  if(nSamples)
+    EncodeFrame();
+  long end=ftell(File);
+  fseek(File,StreamInfoPos,SEEK_SET);
+  WriteStreamInfo();
+  fseek(File,end,SEEK_SET);
+  File=NULL;
+}
+
+
+void TFlacEncoder::EncodeFrame() {
+  int n=nSamples;
+  int assignment=nChannels-1; // independent
+  int channel[2]={LEFT,RIGHT};
+  if(nChannels==2)
+  {
+    for(int i=0;i<n;i++)
+    {
+      int l=Samples[LEFT][i],r=Samples[RIGHT][i];
+      Samples[MID][i]=(l+r)>>1;
+      Samples[SIDE][i]=l-r;
+    }
+    for(int ch=0;ch<NCHANNELS;ch++)
+      AnalyseChannel(ch,(ch==SIDE) ? BitsPerSample+1 : BitsPerSample);
+    // L/R, left/side, right/side, mid/side
+    const int pair[4][2]={{LEFT,RIGHT},{LEFT,SIDE},{SIDE,RIGHT},{MID,SIDE}};
+    const int code[4]={1,8,9,10};
+    int best=0;
+    for(int i=1;i<4;i++)
+      if(Best[pair[i][0]].Bits+Best[pair[i][1]].Bits
+        <Best[pair[best][0]].Bits+Best[pair[best][1]].Bits)
+        best=i;
+    assignment=code[best];
+    channel[0]=pair[best][0];
+    channel[1]=pair[best][1];
+  }
+  else
+    AnalyseChannel(LEFT,BitsPerSample);
+  // frame header
+  Out.nBytes=Out.nBits=0;
+  Out.Put(0x3FFE,14); // sync
+  Out.Put(0,2); // reserved, fixed block size
+  int size_code=(n==BLOCK_SIZE) ? 12 : ((n<=256) ? 6 : 7);
+  Out.Put(size_code,4);
+  Out.Put(0,4); // sample rate as in STREAMINFO
+  Out.Put(assignment,4);
+  Out.Put((BitsPerSample==8) ? 1 : 4,3);
+  Out.Put(0,1);
+  DWORD v=FrameNumber; // "UTF-8" coded
+  if(v<0x80)
+    Out.Put(v,8);
+  else
+  {
+    int nbytes=(v<0x800) ? 2 : (v<0x10000) ? 3 : (v<0x200000) ? 4
+      : (v<0x4000000) ? 5 : 6;
+    Out.Put(((0xFF00>>nbytes)&0xFF)|(v>>(6*(nbytes-1))),8);
+    for(int i=nbytes-2;i>=0;i--)
+      Out.Put(0x80|((v>>(6*i))&0x3F),8);
+  }
+  if(size_code==6)
+    Out.Put(n-1,8);
+  else if(size_code==7)
+    Out.Put(n-1,16);
+  Out.Put(flac_crc8(Out.Buf,Out.nBytes),8);
+  for(int i=0;i<nChannels;i++)
+  {
+    int ch=channel[i];
+    WriteSubframe(Samples[ch],n,(ch==SIDE) ? BitsPerSample+1 : BitsPerSample,
+      Best[ch]);
+  }
+  Out.Align();
+  Out.Put(flac_crc16(Out.Buf,Out.nBytes),16);
+  fwrite(Out.Buf,1,Out.nBytes,File);
+  MinFrameBytes=MIN(MinFrameBytes,(DWORD)Out.nBytes);
+  MaxFrameBytes=MAX(MaxFrameBytes,(DWORD)Out.nBytes);
+  TotalSamples+=n;
+  FrameNumber++;
+  nSamples=0;
+}
+
+
+void TFlacEncoder::AnalyseChannel(int ch,int bps) {
+/*  Find the smallest subframe type for this channel. Candidates are coded
+    in one residual buffer while the best so far stays in the other.
+*/
+  const int *x=Samples[ch];
+  int n=nSamples;
+  TFlacSubframe &best=Best[ch];
+  int i;
+  for(i=1;i<n && x[i]==x[0];i++)
+    ;
+  if(i==n)
+  {
+    best.Type=TFlacSubframe::CONSTANT;
+    best.Bits=bps;
+    return;
+  }
+  best.Type=TFlacSubframe::VERBATIM;
+  best.Bits=n*bps;
+  TFlacSubframe sf;
+  int candidate=0;
+  for(int order=0;order<=MAX_FIXED_ORDER && order<n;order++)
+  {
+    sf.Residual=Residual[ch][candidate];
+    if(TryFixed(x,n,order,bps,sf) && sf.Bits<best.Bits)
+    {
+      best=sf;
+      candidate^=1;
+    }
+  }
+  // autocorrelation of the windowed signal (Welch), then Levinson-Durbin
+  double r[MAX_LPC_ORDER+1];
+  double half=(n+1)*0.5,centre=(n-1)*0.5;
+  for(i=0;i<n;i++)
+  {
+    double t=(i-centre)/half;
+    Windowed[i]=x[i]*(1.0-t*t);
+  }
+  for(int lag=0;lag<=MAX_LPC_ORDER;lag++)
+  {
+    double sum=0;
+    for(i=lag;i<n;i++)
+      sum+=Windowed[i]*Windowed[i-lag];
+    r[lag]=sum;
+  }
+  if(r[0]<=0)
+    return;
+  r[0]*=1.0+1e-9; // a little noise floor keeps it stable
+  double lp[MAX_LPC_ORDER],tmp[MAX_LPC_ORDER],err=r[0];
+  for(int order=1;order<=MAX_LPC_ORDER && order<n;order++)
+  {
+    double acc=r[order];
+    for(i=0;i<order-1;i++)
+      acc-=lp[i]*r[order-1-i];
+    double k=acc/err;
+    for(i=0;i<order-1;i++)
+      tmp[i]=lp[i]-k*lp[order-2-i];
+    for(i=0;i<order-1;i++)
+      lp[i]=tmp[i];
+    lp[order-1]=k;
+    err*=(1.0-k*k);
+    sf.Residual=Residual[ch][candidate];
+    if(TryLpc(x,n,order,lp,bps,sf) && sf.Bits<best.Bits)
+    {
+      best=sf;
+      candidate^=1;
+    }
+    if(err<=0)
+      break;
+  }
+}
+
+
+bool TFlacEncoder::TryFixed(const int *x,int n,int order,int bps,
+                            TFlacSubframe &Sf) {
+  int *res=Sf.Residual;
+  for(int i=order;i<n;i++)
+  {
+    switch(order) {
+    case 0:
+      res[i]=x[i];
+      break;
+    case 1:
+      res[i]=x[i]-x[i-1];
+      break;
+    case 2:
+      res[i]=x[i]-2*x[i-1]+x[i-2];
+      break;
+    case 3:
+      res[i]=x[i]-3*x[i-1]+3*x[i-2]-x[i-3];
+      break;
+    default:
+      res[i]=x[i]-4*x[i-1]+6*x[i-2]-4*x[i-3]+x[i-4];
+      break;
+    }
+  }
+  Sf.Type=TFlacSubframe::FIXED;
+  Sf.Order=(BYTE)order;
+  ChooseRice(res,n,order,Sf);
+  Sf.Bits+=order*bps;
+  return true;
+}
+
+
+bool TFlacEncoder::TryLpc(const int *x,int n,int order,const double *lp,
+                          int bps,TFlacSubframe &Sf) {
+  // quantise the coefficients, carrying the rounding error over
+  double cmax=0;
+  int i;
+  for(i=0;i<order;i++)
+    cmax=MAX(cmax,fabs(lp[i]));
+  if(cmax<=0)
+    return false;
+  int log2cmax;
+  frexp(cmax,&log2cmax);
+  int shift=LPC_PRECISION-2-(log2cmax-1);
+  if(shift>15)
+    shift=15;
+  else if(shift<0)
+    return false;
+  const int qmax=(1<<(LPC_PRECISION-1))-1,qmin=-(1<<(LPC_PRECISION-1));
+  double error=0;
+  for(i=0;i<order;i++)
+  {
+    error+=lp[i]*(1<<shift);
+    int q=(int)floor(error+0.5);
+    if(q>qmax)
+      q=qmax;
+    else if(q<qmin)
+      q=qmin;
+    error-=q;
+    Sf.Coef[i]=q;
+  }
+  int *res=Sf.Residual;
+  for(i=order;i<n;i++)
+  {
+    long long sum=0;
+    for(int j=0;j<order;j++)
+      sum+=(long long)Sf.Coef[j]*x[i-j-1];
+    long long r=x[i]-(sum>>shift);
+    if(r>INT_MAX/2 || r<INT_MIN/2)
+      return false;
+    res[i]=(int)r;
+  }
+  Sf.Type=TFlacSubframe::LPC;
+  Sf.Order=(BYTE)order;
+  Sf.Shift=(BYTE)shift;
+  ChooseRice(res,n,order,Sf);
+  Sf.Bits+=order*bps+4+5+order*LPC_PRECISION;
+  return true;
+}
+
+
+void TFlacEncoder::ChooseRice(const int *res,int n,int order,
+                              TFlacSubframe &Sf) {
+/*  Sums of the folded residuals are computed for the finest partitioning
+    allowed, then merged two by two for each coarser one. The size for a
+    partition of c values summing to s with parameter k is estimated as
+    c*(k+1)+(s>>k), which is never less than the real size.
+*/
+  unsigned long long sum[1<<MAX_PARTITION_ORDER];
+  int max_order=0;
+  while(max_order<MAX_PARTITION_ORDER && !(n&((2<<max_order)-1))
+    && (n>>(max_order+1))>order)
+    max_order++;
+  int parts=1<<max_order,size=n>>max_order;
+  for(int p=0;p<parts;p++)
+  {
+    unsigned long long s=0;
+    for(int i=(p ? p*size : order);i<(p+1)*size;i++)
+      s+=flac_fold(res[i]);
+    sum[p]=s;
+  }
+  int best_bits=INT_MAX;
+  for(int porder=max_order;porder>=0;porder--)
+  {
+    parts=1<<porder;
+    size=n>>porder;
+    if(porder<max_order) // merge
+      for(int p=0;p<parts;p++)
+        sum[p]=sum[2*p]+sum[2*p+1];
+    BYTE param[1<<MAX_PARTITION_ORDER];
+    long long bits=2+4; // coding method, partition order
+    for(int p=0;p<parts;p++)
+    {
+      long long c=(p) ? size : size-order,best_k_bits=LLONG_MAX;
+      for(int k=0;k<=MAX_RICE_PARAM;k++)
+      {
+        long long b=c*(k+1)+(long long)(sum[p]>>k);
+        if(b<best_k_bits)
+        {
+          best_k_bits=b;
+          param[p]=(BYTE)k;
+        }
+      }
+      bits+=4+best_k_bits;
+    }
+    if(bits<best_bits)
+    {
+      best_bits=(int)bits;
+      Sf.PartitionOrder=(BYTE)porder;
+      memcpy(Sf.Param,param,parts);
+    }
+  }
+  Sf.Bits=best_bits;
+}
+
+
+void TFlacEncoder::WriteSubframe(const int *x,int n,int bps,
+                                 const TFlacSubframe &Sf) {
+  int i;
+  Out.Put(0,1); // padding
+  switch(Sf.Type) {
+  case TFlacSubframe::CONSTANT:
+    Out.Put(0,6+1); // type, no wasted bits
+    Out.PutSigned(x[0],bps);
+    return;
+  case TFlacSubframe::VERBATIM:
+    Out.Put(1<<1,6+1);
+    for(i=0;i<n;i++)
+      Out.PutSigned(x[i],bps);
+    return;
+  case TFlacSubframe::FIXED:
+    Out.Put((8|Sf.Order)<<1,6+1);
+    for(i=0;i<Sf.Order;i++) // warm-up
+      Out.PutSigned(x[i],bps);
+    break;
+  case TFlacSubframe::LPC:
+    Out.Put((32|(Sf.Order-1))<<1,6+1);
+    for(i=0;i<Sf.Order;i++)
+      Out.PutSigned(x[i],bps);
+    Out.Put(LPC_PRECISION-1,4);
+    Out.PutSigned(Sf.Shift,5);
+    for(i=0;i<Sf.Order;i++)
+      Out.PutSigned(Sf.Coef[i],LPC_PRECISION);
+    break;
+  }
+  Out.Put(0,2); // Rice, 4bit parameters
+  Out.Put(Sf.PartitionOrder,4);
+  int parts=1<<Sf.PartitionOrder,size=n>>Sf.PartitionOrder;
+  for(int p=0;p<parts;p++)
+  {
+    int k=Sf.Param[p];
+    Out.Put(k,4);
+    for(i=(p ? p*size : Sf.Order);i<(p+1)*size;i++)
+      Out.PutRice(flac_fold(Sf.Residual[i]),k);
+  }
+}
+
+#endif//SSE_SOUND_RECORD_THREAD
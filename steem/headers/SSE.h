@@ -107,6 +107,11 @@ compilation of about everything.
 #define SSE_NO_UNZIPD32 // remove code for unzipd32.dll
 #endif
 
+#if defined(SSE_VC_INTRINSICS) && (defined(_M_IX86) || defined(_M_X64))
+#define SSE_VID_DRAW_C_SIMD // draw_c: SSE2/AVX2 rasters, chosen by CPUID
+#define SSE_VID_LINE_COPY_SIMD // buffered scanline: streaming stores, by CPUID
+#endif
+
 
 // Exception management...
 //#define SSE_M68K_EXCEPTION_TRY_CATCH //works but too slow, especially if _DEBUG
@@ -120,6 +125,13 @@ compilation of about everything.
 
 // Feature switches, still a few, it's nothing compared with before!
 #define SSE_ACSI // hard drive
+#define SSE_CPU_INLINE_REG_EA // Dn, An operands without the EA table call
+#if !defined(DEBUG_BUILD) // breakpoints, monitors, history need all instructions
+#define SSE_CPU_IDLE_LOOP // polling loops and STOP skipped up to next event
+#endif
+#if _MSC_VER>=1900 || defined(STEEM_BENCH) // builds with cpu_model.cpp
+#define SSE_CPU_SPECIALISED_TIMING // opcode handlers compiled per model
+#endif
 #define SSE_DISK_CAPS // IPF, CTR disk images
 //#define SSE_DISK_CAPS_MEMORY // file in memory
 #define SSE_DISK_STW // MFM disk image format
@@ -132,14 +144,22 @@ compilation of about everything.
 #define SSE_INT_MFP_EVENT_IRQ // interrupts in event count mode - to check
 //#define SSE_INT_MFP_OPTION // option 68901 (=TRUE if not defined)
 #define SSE_MEGASTF_RTC // Ricoh chip //TODO linux
+#define SSE_MMU_PAGE_TABLE // RAM, TOS reads through a table of 64KB pages
 #define SSE_SHIFTER_UNSTABLE
 #define SSE_SOUND_16BIT_CENTRED
+#define SSE_SOUND_ADAPTIVE_LATENCY // write-ahead follows underruns, lock-free X ring
 #define SSE_SOUND_CARTRIDGE // B.A.T etc.
+#define SSE_SOUND_DRC // dynamic rate control, emulated sample rate +/-0.5%
+#define SSE_SOUND_PROFILE // stage timing and latency probe, OSD and CSV
+#define SSE_SOUND_RECORD_THREAD // file written by a thread, FLAC format
 //#define SSE_SOUND_OPTION_DISABLE_DSP // option is disabled!
 #define SSE_TOS_KEYBOARD_CLICK // hack to suppress the click
 #define SSE_VID_CHECK_VIDEO_RAM
+#define SSE_VID_DRAW_THREADS // option: scanlines converted by a pool of threads
+#define SSE_VID_LINE_CACHE // scanlines are converted only if they changed
 #define SSE_WD1772_LL // low-level elements (3rd party-inspired)
 #define SSE_YM2149_LL // low-level emu (3rd party-inspired)
+#define SSE_YM2149_MIX_TABLE // embedded volume table, envelope levels precomputed
 
 #ifdef WIN32 //todo, some features could be added to XSteem
 #define SSE_ARCHIVEACCESS_SUPPORT // 7z + ...
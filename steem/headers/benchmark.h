@@ -0,0 +1,124 @@
+/*---------------------------------------------------------------------------
+PROJECT: Steem SSE
+Atari ST emulator
+Copyright (C) 2020 by Anthony Hayward and Russel Hayward + SSE
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see https://www.gnu.org/licenses/.
+
+DOMAIN: Emu
+FILE: benchmark.h
+DESCRIPTION: Declarations for the headless benchmark runner (Linux,
+'make bench' in X-build), and the timing scopes it shares with the sound
+profiler (SSE_SOUND_PROFILE).
+struct TBenchmark, TBenchScope
+---------------------------------------------------------------------------*/
+
+#pragma once
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#if defined(STEEM_BENCH) || defined(SSE_SOUND_PROFILE)
+
+#include <time.h>
+#include <easystr.h>
+#include <conditions.h>
+#if !defined(STEEM_BENCH) && defined(__GNUC__) \
+  && (defined(__i386__) || defined(__x86_64__))
+#include <x86intrin.h>
+#endif
+
+#if defined(STEEM_BENCH)
+#define BENCH_ONLY(s) s
+#else
+#define BENCH_ONLY(s)
+#endif
+// time the enclosing block and charge it to a subsystem
+#define BENCH_SCOPE(subsystem) TBenchScope bench_scope_(TBenchmark::subsystem)
+
+struct TBenchmark {
+  enum ESubsystem {CPU,EVENTS,VIDEO,SOUND,
+    PSG,ANTIALIAS,MICROWIRE,MIX,DEVICE, // sound stages, see TSoundProfile
+    NSUBSYSTEMS,NSOUNDSTAGES=NSUBSYSTEMS-PSG};
+  // FUNCTIONS
+  TBenchmark();
+#if defined(STEEM_BENCH)
+  int Main(int argc,char *argv[]);
+  bool ParseCommandLine(int argc,char *argv[]);
+  void PrintUsage();
+  bool Init();
+  void Run();
+  void Report();
+  void Vbl(); // called by event_vbl_interrupt()
+#endif
+  void Start();
+  int Switch(int subsystem);
+  void Charge(int subsystem,unsigned long long ticks);
+  static unsigned long long SystemUs();
+/*  The bench counts nanoseconds. The profiler reads the time stamp counter
+    where there's one, it's cheaper, and converts against SystemUs().
+*/
+  static inline unsigned long long Now() {
+#if defined(STEEM_BENCH)
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (unsigned long long)ts.tv_sec*1000000000ull+ts.tv_nsec;
+#elif defined(SSE_VC_INTRINSICS) && (defined(_M_IX86) || defined(_M_X64))
+    return __rdtsc();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    return __rdtsc();
+#else
+    return SystemUs();
+#endif
+  }
+  // DATA
+#if defined(STEEM_BENCH)
+  EasyStr TosFile,DiskFile[2];
+  unsigned long long WallTime; // ns
+  unsigned long long Cycles; // emulated CPU cycles
+  COUNTER_VAR LastAct;
+  DWORD nFrames,FramesToRun;
+  BYTE Model;
+  BYTE MemConf[2];
+#endif
+  unsigned long long SubsystemTime[NSUBSYSTEMS]; // exclusive of nested scopes
+  unsigned long long LastSwitch;
+  int Current; // subsystem being charged
+  bool Active;
+};
+
+extern TBenchmark Bench;
+
+/*  Time spent in the scope is charged to its subsystem only, the enclosing
+    scope is paused until we return to it.
+*/
+
+struct TBenchScope {
+  TBenchScope(int subsystem) {
+    m_Parent=(Bench.Active) ? Bench.Switch(subsystem) : -1;
+  }
+  ~TBenchScope() {
+    if(m_Parent>=0)
+      Bench.Switch(m_Parent);
+  }
+  int m_Parent;
+};
+
+#else
+
+#define BENCH_ONLY(s)
+#define BENCH_SCOPE(subsystem)
+
+#endif//STEEM_BENCH || SSE_SOUND_PROFILE
+
+#endif//BENCHMARK_H
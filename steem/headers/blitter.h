@@ -55,7 +55,7 @@ struct TBlitter {
   BYTE dummy2;
   BYTE Request; //0-3
   BYTE BusAccessCounter; // count accesses by blitter and by CPU in blit mode
-  byte LineNumber; //4bit counter
+  BYTE LineNumber; //4bit counter
   // v402
   int nWordsToBlit,nWordsBlitted; // debug
   BYTE rBusy; // register different from busy line
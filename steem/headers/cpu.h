@@ -51,6 +51,15 @@ struct TMC68000, m68k_exception, TIplTiming
 
 extern void (*m68k_call_table[0xffff+1])(); // 65536 function pointers
 void cpu_routines_init();
+#if defined(SSE_CPU_SPECIALISED_TIMING)
+// same tables filled with handlers that call the model's timing directly
+namespace CpuStf { void cpu_routines_init(); }
+namespace CpuSte { void cpu_routines_init(); }
+#if defined(SSE_MEGASTE)
+namespace CpuMegaSte { void cpu_routines_init(); }
+#endif
+extern void (*cpu_routines_installed)(); // last init function called
+#endif
 #if defined(SSE_VC_INTRINSICS)
 extern int (*count_bits_set_in_word)(unsigned short);
 #endif
@@ -240,6 +249,38 @@ extern BYTE ipl_timing_index;
 
 #define CHECK_IPL tvn_latch_time=ACT // macro placed in each opcode function
 
+#if defined(SSE_CPU_IDLE_LOOP)
+/*  Idle loop: a short loop (or STOP) that doesn't write, doesn't access IO
+    and comes back to its start with the same registers, flags and cycle
+    alignment will do exactly the same until the next event.
+    The iterations before the event are skipped at once.
+*/
+
+#define IDLE_LOOP_MAX_BYTES 32 // from branch to loop start
+
+struct TIdleLoop {
+  // FUNCTIONS
+  TIdleLoop() { Pc=0xFFFFFFFF; Recorded=false; Impure=true; SkippedCycles=0; }
+  void Check();
+  // DATA
+  COUNTER_VAR Start; // ACT at loop start
+  COUNTER_VAR SkippedCycles; // for benchmark
+  MEM_ADDRESS Pc; // loop start
+  signed int r[17];
+  DWORDLONG Flags;
+  WORD sr;
+  BYTE Alignment; // cpu_cycles&3
+  BYTE BusAccesses; // Blitter counter at loop start
+  bool Recorded;
+  bool Impure; // write, IO, event since last check
+};
+
+extern TIdleLoop IdleLoop;
+#define IDLE_LOOP_IMPURE IdleLoop.Impure=true;
+#else
+#define IDLE_LOOP_IMPURE
+#endif
+
 #define SR_IPL   (BIT_a+BIT_9+BIT_8 )
 #define SR_IPL_7 (BIT_a+BIT_9+BIT_8 )
 #define SR_IPL_6 (BIT_a+BIT_9       )
@@ -345,32 +386,86 @@ void m68k_get_dest_111_w();
 void m68k_get_dest_111_l();
 
 
+/*  Register direct modes (Dn, An) take no time and no bus access, they're
+    resolved here instead of through a second indirect call. For modes 000
+    and 001, IRD&0xF is the index in cpureg (bit 3 set for An).
+*/
+
+#if defined(SSE_CPU_INLINE_REG_EA)
+#define EA_IS_REGISTER ((IRD&BITS_543)<=BITS_543_001)
+#define EA_IS_DN ((IRD&BITS_543)==BITS_543_000)
+#define EA_REGISTER (IRD&0xF)
+#endif
+
+
 inline void m68kGetDestByte() {
+#if defined(SSE_CPU_INLINE_REG_EA)
+  if(EA_IS_REGISTER)
+  {
+    m68k_dst_b=REGB(EA_REGISTER);
+    return;
+  }
+#endif
   m68k_jsr_get_dest_b[(IRD&BITS_543)>>3]();
 }
 
 
 inline void m68kGetDestWord() {
+#if defined(SSE_CPU_INLINE_REG_EA)
+  if(EA_IS_REGISTER)
+  {
+    m68k_dst_w=REGW(EA_REGISTER);
+    return;
+  }
+#endif
   m68k_jsr_get_dest_w[(IRD&BITS_543)>>3]();
 }
 
 
 inline void m68kGetDestLong() {
+#if defined(SSE_CPU_INLINE_REG_EA)
+  if(EA_IS_REGISTER)
+  {
+    m68k_dst_l=REGL(EA_REGISTER);
+    return;
+  }
+#endif
   m68k_jsr_get_dest_l[(IRD&BITS_543)>>3]();
 }
 
 
 inline void m68kGetDestByteNotA() {
+#if defined(SSE_CPU_INLINE_REG_EA)
+  if(EA_IS_DN)
+  {
+    m68k_dst_b=REGB(EA_REGISTER);
+    return;
+  }
+#endif
   m68k_jsr_get_dest_b_not_a[(IRD&BITS_543)>>3]();
 }
 
 
 inline void m68kGetDestWordNotA() {
+#if defined(SSE_CPU_INLINE_REG_EA)
+  if(EA_IS_DN)
+  {
+    m68k_dst_w=REGW(EA_REGISTER);
+    return;
+  }
+#endif
   m68k_jsr_get_dest_w_not_a[(IRD&BITS_543)>>3]();
 }
 
 
 inline void m68kGetDestLongNotA() {
+#if defined(SSE_CPU_INLINE_REG_EA)
+  if(EA_IS_DN)
+  {
+    m68k_dst_l=REGL(EA_REGISTER);
+    return;
+  }
+#endif
   m68k_jsr_get_dest_l_not_a[(IRD&BITS_543)>>3]();
 }
 
@@ -391,31 +486,73 @@ inline void m68kGetDestLongNotAOrD() {
 
 
 inline void m68kGetSourceByte() {
+#if defined(SSE_CPU_INLINE_REG_EA)
+  if(EA_IS_REGISTER)
+  {
+    m68k_src_b=REGB(EA_REGISTER);
+    return;
+  }
+#endif
   m68k_jsr_get_source_b[(IRD&BITS_543)>>3]();
 }
 
 
 inline void m68kGetSourceWord() {
+#if defined(SSE_CPU_INLINE_REG_EA)
+  if(EA_IS_REGISTER)
+  {
+    m68k_src_w=REGW(EA_REGISTER);
+    return;
+  }
+#endif
   m68k_jsr_get_source_w[(IRD&BITS_543)>>3]();
 }
 
 
 inline void m68kGetSourceLong() {
+#if defined(SSE_CPU_INLINE_REG_EA)
+  if(EA_IS_REGISTER)
+  {
+    m68k_src_l=REGL(EA_REGISTER);
+    return;
+  }
+#endif
   m68k_jsr_get_source_l[(IRD&BITS_543)>>3]();
 }
 
 
 inline void m68kGetSourceByteNotA() {
+#if defined(SSE_CPU_INLINE_REG_EA)
+  if(EA_IS_DN)
+  {
+    m68k_src_b=REGB(EA_REGISTER);
+    return;
+  }
+#endif
   m68k_jsr_get_source_b_not_a[(IRD&BITS_543)>>3]();
 }
 
 
 inline void m68kGetSourceWordNotA() {
+#if defined(SSE_CPU_INLINE_REG_EA)
+  if(EA_IS_DN)
+  {
+    m68k_src_w=REGW(EA_REGISTER);
+    return;
+  }
+#endif
   m68k_jsr_get_source_w_not_a[(IRD&BITS_543)>>3]();
 }
 
 
 inline void m68kGetSourceLongNotA() {
+#if defined(SSE_CPU_INLINE_REG_EA)
+  if(EA_IS_DN)
+  {
+    m68k_src_l=REGL(EA_REGISTER);
+    return;
+  }
+#endif
   m68k_jsr_get_source_l_not_a[(IRD&BITS_543)>>3]();
 }
 
@@ -603,64 +740,51 @@ BYTE &pswC=uflags.d8[0];  d16[0]H   d32[0]HH
   CLEAR_VC; \
   SR_CHECK_Z_AND_N_L; 
 
-#define SR_SUB_B(extend_flag)           \
-  pswV=(( ( ((~m68k_src_b)&( m68k_dst_b)&(~resultb))|  \
-        (( m68k_src_b)&(~m68k_dst_b)&( resultb)) ) & MSB_B)!=0);\
-  pswC=(( ( (( m68k_src_b)&(~m68k_dst_b)) |  \
-        (( resultb)&(~m68k_dst_b))|  \
-        (( m68k_src_b)&( resultb)) ) & MSB_B)!=0); \
+/*  ADD, ADDI, ADDQ, SUB, SUBI, SUBQ, CMP, CMPI, CMPA, CMPM
+    result is always dst+src or dst-src (no extend), so that carry (borrow)
+    is a simple unsigned compare and overflow is the sign of two XORs, instead
+    of evaluating the generic bit equations of the manual for each flag.
+    Same flags, fewer operations.
+*/
+
+#define SR_SUB_B(extend_flag) \
+  pswV=(((m68k_src_b^m68k_dst_b)&(resultb^m68k_dst_b)&MSB_B)!=0); \
+  pswC=((BYTE)m68k_src_b>(BYTE)m68k_dst_b); \
   if(extend_flag) pswX=pswC; \
   pswZ=(resultb==0); \
   pswN=(resultb<0);
 
-
-
-#define SR_SUB_W(extend_flag)           \
-  pswV=(( ( ((~m68k_src_w)&( m68k_dst_w)&(~resultl))|  \
-        (( m68k_src_w)&(~m68k_dst_w)&( resultl)) ) & MSB_W)!=0); \
-  pswC=(( ( (( m68k_src_w)&(~m68k_dst_w)) |  \
-        (( resultl)&(~m68k_dst_w))|  \
-        (( m68k_src_w)&( resultl)) ) & MSB_W)!=0); \
+#define SR_SUB_W(extend_flag) \
+  pswV=(((m68k_src_w^m68k_dst_w)&(resultl^m68k_dst_w)&MSB_W)!=0); \
+  pswC=((WORD)m68k_src_w>(WORD)m68k_dst_w); \
   if(extend_flag) pswX=pswC; \
   pswZ=(resultl==0); \
-  pswN=(resultl<0); 
-
-#define SR_SUB_L(extend_flag)           \
-  pswV=(( ( ((~m68k_src_l)&( m68k_dst_l)&(~result))|  \
-        (( m68k_src_l)&(~m68k_dst_l)&( result)) ) & MSB_L)!=0); \
-  pswC=(( ( (( m68k_src_l)&(~m68k_dst_l)) |  \
-        (( result)&(~m68k_dst_l))|  \
-        (( m68k_src_l)&( result)) ) & MSB_L)!=0); \
+  pswN=(resultl<0);
+
+#define SR_SUB_L(extend_flag) \
+  pswV=(((m68k_src_l^m68k_dst_l)&(result^m68k_dst_l)&MSB_L)!=0); \
+  pswC=((DWORD)m68k_src_l>(DWORD)m68k_dst_l); \
   if(extend_flag) pswX=pswC; \
   pswZ=(result==0); \
-  pswN=(result<0); 
-
-#define SR_ADD_B                                                    \
-  pswV=(( ( (( m68k_src_b)&( m68k_dst_b)&(~resultb))|                \
-        ((~m68k_src_b)&(~m68k_dst_b)&( resultb)) ) & MSB_B)!=0);     \
-  pswX=pswC=(( ( (( m68k_src_b)&( m68k_dst_b)) |                              \
-        ((~resultb)&( m68k_dst_b))|                              \
-        (( m68k_src_b)&(~resultb)) ) & MSB_B)!=0);                      \
-  pswZ=(resultb==0);                                         \
-  pswN=((resultb & MSB_B)!=0);                                  \
-
-#define SR_ADD_W                                                    \
-  pswV=(( ( (( m68k_src_w)&( m68k_dst_w)&(~resultl))|                \
-        ((~m68k_src_w)&(~m68k_dst_w)&( resultl)) ) & MSB_W)!=0);     \
-  pswX=pswC=(( ( (( m68k_src_w)&( m68k_dst_w)) |                              \
-        ((~resultl)&( m68k_dst_w))|                              \
-        (( m68k_src_w)&(~resultl)) ) & MSB_W)!=0);                      \
-  pswZ=(resultl==0);                                         \
-  pswN=((resultl & MSB_W)!=0);                                  \
-
-#define SR_ADD_L                                                    \
-  pswV=(( ( (( m68k_src_l)&( m68k_dst_l)&(~result))|                \
-        ((~m68k_src_l)&(~m68k_dst_l)&( result)) ) & MSB_L)!=0);     \
-  pswX=pswC=(( ( (( m68k_src_l)&( m68k_dst_l)) |                              \
-        ((~result)&( m68k_dst_l))|                              \
-        (( m68k_src_l)&(~result)) ) & MSB_L)!=0);                      \
-  pswZ=(result==0);                                         \
-  pswN=(result<0);                                  \
+  pswN=(result<0);
+
+#define SR_ADD_B \
+  pswV=(((m68k_src_b^resultb)&(m68k_dst_b^resultb)&MSB_B)!=0); \
+  pswX=pswC=((BYTE)resultb<(BYTE)m68k_src_b); \
+  pswZ=(resultb==0); \
+  pswN=(resultb<0);
+
+#define SR_ADD_W \
+  pswV=(((m68k_src_w^resultl)&(m68k_dst_w^resultl)&MSB_W)!=0); \
+  pswX=pswC=((WORD)resultl<(WORD)m68k_src_w); \
+  pswZ=(resultl==0); \
+  pswN=(resultl<0);
+
+#define SR_ADD_L \
+  pswV=(((m68k_src_l^result)&(m68k_dst_l^result)&MSB_L)!=0); \
+  pswX=pswC=((DWORD)result<(DWORD)m68k_src_l); \
+  pswZ=(result==0); \
+  pswN=(result<0);
 
 
 inline void change_to_user_mode() {
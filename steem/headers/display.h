@@ -88,7 +88,11 @@ enum EDisplay {
 #ifdef STEEM_CRT
   DISPMETHOD_CRT,
 #endif
-  DISPMETHOD_X,DISPMETHOD_XSHM,DISPMETHOD_BE,NFSRES=40,
+  DISPMETHOD_X,DISPMETHOD_XSHM,DISPMETHOD_BE,
+#ifdef STEEM_BENCH
+  DISPMETHOD_NULL,
+#endif
+  NFSRES=40,
 // 501x224 = 112224
 // 8021247/112224 = 71.47532613344739
 // but mega
@@ -163,6 +167,11 @@ private:
   bool CheckDisplayMode(DWORD,DWORD,DWORD);
   bool InitX();
   bool InitXSHM();
+#ifdef STEEM_BENCH
+public:
+  bool InitNull(); // host memory surface, nothing is shown
+private:
+#endif
 #ifndef NO_XVIDMODE
   static int XVM_WinProc(void*,Window,XEvent*);
 #endif
@@ -224,20 +233,33 @@ public: //temp
   BYTE* CRTBmpMem;
   HWND CRThwnd;
   BYTE CRTFullscreen;
-  unsigned int* CRTpixels;
-  int CRTwidth;
-  int CRTheight;
+  // Triple buffer: Blit() fills CRTframe[CRTwriteFrame] then swaps its index
+  // with CRTlatestFrame (+CRT_FRAME_FRESH), the CRT thread swaps its own
+  // index with CRTlatestFrame when it sees the flag. No copy, no lock.
+  struct TCRTFrame {
+    unsigned int* pixels;
+    int width;
+    int height;
+  } CRTframe[3];
+  int CRTwriteFrame;
+  thread_atomic_int_t CRTlatestFrame;
+  thread_atomic_int_t CRTviewChanged; // present again with the new view
   int CRTviewy;
   int CRTvieww;
   int CRTviewh;
   int CRTexit;
   thread_ptr_t CRTthread;
-  thread_mutex_t CRTmutex;
-  thread_signal_t CRTsignal;
+  thread_signal_t CRTsignal; // raised by the CRT thread after a present
+  thread_signal_t CRTframeSignal; // raised when there's something to present
   int CRTthreadProc();
   static int CRTthreadWrapper( void* );
+  void CRTUpdateView();
 
 #endif
+#ifdef STEEM_BENCH
+  BYTE* NullBmpMem;
+  int NullBmpLineLength;
+#endif
 #ifdef WIN32
   HBITMAP GDIBmp;
   BYTE *GDIBmpMem;
@@ -314,8 +336,8 @@ public: //temp
 #ifndef NO_XVIDMODE
   XF86VidModeModeInfo **XVM_Modes;
   int XVM_nModes,XVM_ViewX,XVM_ViewY;
-  int XVM_FullW,XVM_FullH;
 #endif
+  int XVM_FullW,XVM_FullH;
 #ifndef NO_SHM
   int SHMCompletion;
   XShmSegmentInfo XSHM_Info;
@@ -120,6 +120,73 @@ extern bool freq_change_this_scanline;
 void get_fullscreen_totalrect(RECT* rc);
 #endif
 
+#if defined(SSE_VID_LINE_CACHE)
+/*  Scanline cache. Most of the time, ST pictures don't change much from
+    frame to frame, yet every scanline was converted again by the draw
+    routines. We keep a signature of what was drawn on each line of the
+    locked PC video memory: a 64bit hash of the video RAM the routine reads,
+    of the PC palette, the shift mode and the Glue tricks, plus the exact
+    border/picture/hscroll parameters and the routine. If they match, the
+    pixels already in the buffer are right and the routine isn't called.
+    Only lines drawn in one go are cached, lines with rasters are converted
+    in several parts and always drawn.
+    Anything else that writes into the buffer (OSD, clearing) must
+    invalidate the cache.
+    The same data tells whether the frame changed since the last blit. If
+    it didn't, the blit can be skipped (option SkipUnchanged): no upload,
+    no shader pass, and the run loop paces the frame with its timer.
+*/
+
+struct TScanlineCache {
+  enum {NLINES=1024}; // PC lines
+  struct TLine {
+    DWORD Hash[2]; // 64bit
+    LPPIXELWISESCANPROC Routine;
+    short Border1,Picture,Border2;
+    BYTE Hscroll;
+    bool Valid;
+  };
+  // FUNCTIONS
+  TScanlineCache();
+  void Frame(); // after lock
+  void Invalidate();
+  void Invalidate(BYTE *from); // lines from this address on
+  bool Skip(int border1,int picture,int border2,int hscroll,bool whole_line);
+  bool SkipBlit(); // after draw_end()
+  // DATA
+  TLine Line[NLINES];
+  BYTE *DrawMem;
+  int LineLength,IncreaseY;
+  COUNTER_VAR nHit,nMiss,nSkippedFrames;
+  BYTE Enabled; // option
+  BYTE SkipUnchanged; // option
+  bool Active; // this frame
+  bool Dirty; // buffer changed or host window exposed since the last blit
+};
+
+extern TScanlineCache ScanlineCache;
+
+#endif
+
+// draw_scanline() unless the line is in the cache
+inline void draw_scanline_cached(int border1,int picture,int border2,
+                                 int hscroll,bool whole_line) {
+#if defined(SSE_VID_LINE_CACHE)
+  if(!ScanlineCache.Skip(border1,picture,border2,hscroll,whole_line))
+#endif
+    draw_scanline(border1,picture,border2,hscroll);
+}
+
+#if defined(SSE_VID_DRAW_C_SIMD)
+/*  SSE2/AVX2 kernels for the full 16-pixel rasters (draw.cpp), NULL if the
+    CPU has no SSE2. Source is the address of the first plane word in
+    reversed memory (Mem_End_minus_2-source), the next words are below.
+*/
+typedef BYTE* (*LPDRAWCBLOCKSPROC)(const BYTE *source,int nblocks,int nplanes,
+  const DWORD *pal,BYTE *dest,int line_length,int width,bool two_lines);
+extern LPDRAWCBLOCKSPROC draw_c_blocks;
+#endif
+
 #ifdef WIN32
 
 // This is for the new scanline buffering (v2.6). If you write a lot direct
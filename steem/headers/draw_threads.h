@@ -0,0 +1,101 @@
+/*---------------------------------------------------------------------------
+PROJECT: Steem SSE
+Atari ST emulator
+Copyright (C) 2020 by Anthony Hayward and Russel Hayward + SSE
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see https://www.gnu.org/licenses/.
+
+DOMAIN: Rendering
+FILE: draw_threads.h
+DESCRIPTION: Declarations for the scanline conversion threads.
+struct TDrawCommand, TDrawBatch, TDrawThreads
+---------------------------------------------------------------------------*/
+
+#pragma once
+#ifndef DRAW_THREADS_H
+#define DRAW_THREADS_H
+
+#if defined(SSE_VID_DRAW_THREADS)
+
+#include <conditions.h>
+#include "draw.h"
+#include "../../thread.h"
+
+// the 32bit routines taken over, in the order of draw_32_routine[]
+enum EDraw32Routine {DRAW32_LOWRES,DRAW32_LOWRES_DW,DRAW32_LOWRES_400,
+  DRAW32_MEDRES,DRAW32_MEDRES_400,DRAW32_HIRES,NDRAW32_ROUTINES};
+
+/*  One call of a 32bit scanline routine, with everything it reads: the
+    video RAM of the line, copied as it's stored (reversed), the palette,
+    and where to draw.
+*/
+
+struct TDrawCommand {
+  enum {MAX_DATA=512};
+  BYTE *Dest;
+  DWORD Pal[16];
+  int LineLength; // for double height
+  short Border1,Picture,Border2;
+  short nData;
+  BYTE Routine; // EDraw32Routine, the 32bit routine to emulate
+  BYTE Hscroll;
+  BYTE Inverted; // monochrome, STpal[0]&1
+  BYTE Data[MAX_DATA];
+};
+
+
+struct TDrawBatch {
+  int First,Count; // in TDrawThreads::Command
+};
+
+
+struct TDrawThreads {
+  enum {MAX_THREADS=8,NCOMMANDS=2048,BATCH_SIZE=16,
+    NBATCHES=NCOMMANDS/BATCH_SIZE};
+  // FUNCTIONS
+  TDrawThreads();
+  ~TDrawThreads();
+  bool Start(int nthreads);
+  void Stop();
+  void Frame(); // after draw_set_jumps_and_source()
+  void Record(int routine,int border1,int picture,int border2,int hscroll,
+    int nbytes_out);
+  void Submit();
+  void Sync();
+  static int WorkerThread(void *p);
+  static void Convert(const TDrawCommand &cmd);
+  // DATA
+  TDrawCommand *Command;
+  TDrawBatch Batch[NBATCHES];
+  struct TWorker {
+    TDrawThreads *Pool;
+    thread_ptr_t Thread;
+    thread_queue_t Queue; // emulator -> worker, NULL to quit
+    void *Values[NBATCHES+1];
+  } Worker[MAX_THREADS];
+  thread_atomic_int_t nBusy; // batches not converted yet
+  thread_signal_t Done; // nBusy reached 0
+  BYTE *HighWater; // end of the last command in PC memory
+  COUNTER_VAR nConverted,nSync,nDirect;
+  int nCommands,nBatches,BatchStart,NextWorker;
+  int nThreads; // running
+  BYTE Threads; // option, 0: off
+  bool Active; // this frame
+};
+
+extern TDrawThreads DrawThreads;
+
+#endif//SSE_VID_DRAW_THREADS
+
+#endif//DRAW_THREADS_H
@@ -615,6 +615,17 @@ struct TStats {
   COUNTER_VAR nGemdos,nBios,nXbios,nVdi,nAes;
   COUNTER_VAR nGemdosi,nBiosi,nXbiosi,nVdii;
   COUNTER_VAR nPorti[3],nPorto[3],nMfpTimeout[4];
+#if defined(SSE_SOUND_ADAPTIVE_LATENCY)
+  COUNTER_VAR nSoundUnderrun;
+  int SoundFill,SoundFillMin,SoundTarget,SoundJitter; // in samples
+#endif
+#if defined(SSE_SOUND_DRC)
+  int SoundDrcPpm;
+#endif
+#if defined(SSE_SOUND_PROFILE)
+  int SoundStageUs[5]; // last second: PSG, antialias, microwire, mix, device
+  int SoundProbeDeviceUs,SoundProbeOutputUs;
+#endif
   DWORD nPal,nTimerbtick,nBlit1,nHbi1,nReadvc1,nScreensplit1; // per frame
   DWORD nLinePlus16; 
   DWORD mskSpecial,mskDigitalSound,mskOverscan,mskOverscan1;
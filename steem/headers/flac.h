@@ -0,0 +1,99 @@
+/*---------------------------------------------------------------------------
+PROJECT: Steem SSE
+Atari ST emulator
+Copyright (C) 2020 by Anthony Hayward and Russel Hayward + SSE
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see https://www.gnu.org/licenses/.
+
+DOMAIN: Sound
+FILE: flac.h
+DESCRIPTION: Declarations for the FLAC encoder used to record sound.
+struct TFlacEncoder
+---------------------------------------------------------------------------*/
+
+#pragma once
+#ifndef FLAC_H
+#define FLAC_H
+
+#if defined(SSE_SOUND_RECORD_THREAD)
+
+#include <stdio.h>
+#include <conditions.h>
+
+struct TFlacBits { // MSB first, like the format
+  void Put(DWORD Value,int Bits);
+  void PutSigned(int Value,int Bits) {
+    Put((DWORD)Value,Bits);
+  }
+  void PutRice(DWORD Value,int Param);
+  void Align() {
+    if(nBits)
+      Put(0,8-nBits);
+  }
+  BYTE *Buf;
+  int nBytes;
+  int nBits;
+  unsigned long long Acc;
+};
+
+
+struct TFlacSubframe {
+  enum {CONSTANT,VERBATIM,FIXED,LPC};
+  BYTE Type,Order,PartitionOrder,Shift;
+  BYTE Param[256]; // Rice parameter of each partition
+  int Coef[32];
+  int Bits; // estimated size
+  int *Residual;
+};
+
+
+struct TFlacEncoder {
+  enum {BLOCK_SIZE=4096,MAX_FIXED_ORDER=4,MAX_LPC_ORDER=8,LPC_PRECISION=12,
+    MAX_PARTITION_ORDER=8,MAX_RICE_PARAM=14};
+  enum {LEFT,RIGHT,MID,SIDE,NCHANNELS}; // channels we may encode
+  // FUNCTIONS
+  TFlacEncoder();
+  ~TFlacEncoder();
+  bool Open(FILE *f,int freq,int channels,int bits);
+  void Write(const BYTE *Pcm,int Bytes); // as in a WAV file
+  void Close(); // completes STREAMINFO, the file stays open
+  void PutSampleFrame(const BYTE *p);
+  void EncodeFrame();
+  void AnalyseChannel(int ch,int bps);
+  bool TryFixed(const int *x,int n,int order,int bps,TFlacSubframe &Sf);
+  bool TryLpc(const int *x,int n,int order,const double *lp,int bps,
+    TFlacSubframe &Sf);
+  void ChooseRice(const int *res,int n,int order,TFlacSubframe &Sf);
+  void WriteSubframe(const int *x,int n,int bps,const TFlacSubframe &Sf);
+  void WriteStreamInfo();
+  // DATA
+  FILE *File;
+  long StreamInfoPos;
+  int Freq,nChannels,BitsPerSample,BytesPerFrame;
+  int *Samples[NCHANNELS];
+  int *Residual[NCHANNELS][2]; // best, candidate
+  double *Windowed;
+  TFlacSubframe Best[NCHANNELS];
+  int nSamples; // in the current block
+  DWORD FrameNumber;
+  unsigned long long TotalSamples;
+  DWORD MinFrameBytes,MaxFrameBytes;
+  BYTE Partial[4]; // sample frame split between two writes
+  int nPartial;
+  TFlacBits Out;
+};
+
+#endif//SSE_SOUND_RECORD_THREAD
+
+#endif//FLAC_H
@@ -140,6 +140,26 @@ void GetCurrentMemConf(BYTE[2]);
 
 extern const MEM_ADDRESS mmu_bank_length_from_config[N_MEMCONF];
 
+#if defined(SSE_MMU_PAGE_TABLE)
+/*  One entry per 64KB page of the 24bit bus: host base of a page that can be
+    read directly (RAM, TOS), or NULL for the full decoding in m68k_peek()...
+*/
+#define MMU_PAGE_SHIFT 16
+#define MMU_N_PAGES 256
+#if defined(BIG_ENDIAN_PROCESSOR)
+#define MMU_PAGE_PEEK(base,ad)  *(BYTE*)((base)+(ad))
+#define MMU_PAGE_DPEEK(base,ad) *(WORD*)((base)+(ad))
+#else
+#define MMU_PAGE_PEEK(base,ad)  *(BYTE*)((base)+1-(ad))
+#define MMU_PAGE_DPEEK(base,ad) *(WORD*)((base)-(ad))
+#endif
+extern BYTE *mmu_page_base[MMU_N_PAGES];
+void mmu_update_page_table();
+#define MMU_UPDATE_PAGE_TABLE mmu_update_page_table();
+#else
+#define MMU_UPDATE_PAGE_TABLE
+#endif
+
 
 /////////////////
 // Sound (STE) //
@@ -407,7 +407,11 @@ struct TOption {
   BYTE FastBlitter;
 #if defined(__cplusplus)
   BYTE SoundRecordFormat;
-  enum EOption {SoundFormatWav,SoundFormatYm};
+#if defined(SSE_SOUND_RECORD_THREAD)
+  enum EOption {SoundFormatWav,SoundFormatYm,SoundFormatFlac,NSoundFormats};
+#else
+  enum EOption {SoundFormatWav,SoundFormatYm,NSoundFormats};
+#endif
   TOption();
   void Init();
   void Restore(bool all=false);
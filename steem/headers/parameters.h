@@ -166,6 +166,7 @@ Some STFs                32.02480    8.0071
 #else
 #define STEEM_STATS_FILENAME "stats.txt"
 #endif
+#define SOUND_PROFILE_FILENAME "sound_profile.csv"
 
 
 /////////
@@ -70,38 +70,10 @@ struct TEvent
               default:      video_freq_idx=2;   \
             }
 
-// could we inline?
-
-#define PREPARE_EVENT_CHECK_FOR_TIMER_TIMEOUTS(tn)      \
-    if (mfp_timer_enabled[tn] || mfp_timer_period_change[tn]){                           \
-      if ((time_of_next_event-mfp_timer_timeout[tn]) >= 0){  \
-        time_of_next_event=mfp_timer_timeout[tn];          \
-        event_vector=event_mfp_timer_timeout[tn];    \
-      }                                                     \
-    }
-
-
-#define PREPARE_EVENT_CHECK_FOR_TIMER_B       \
-  if (Mfp.reg[MFPR_TBCR]==8){  \
-    if ((time_of_next_event-time_of_next_timer_b) >= 0){                 \
-      time_of_next_event=time_of_next_timer_b;     \
-      event_vector=event_timer_b;                    \
-    }                                    \
-  }
-
-
 #ifdef DEBUG_BUILD
 
 void event_debug_stop();
 
-#define PREPARE_EVENT_CHECK_FOR_DEBUG       \
-  if (debug_run_until==DRU_CYCLE){    \
-    if ((time_of_next_event-debug_run_until_val) >= 0){                 \
-      time_of_next_event=debug_run_until_val;  \
-      event_vector=event_debug_stop;                    \
-    }    \
-  }
-
 #define CHECK_BREAKPOINT                     \
         if (debug_num_bk){ \
           if (debug_first_instruction==0) breakpoint_check();     \
@@ -115,51 +87,12 @@ extern int stem_runmode;
 
 #else
 
-#define PREPARE_EVENT_CHECK_FOR_DEBUG
 #define CHECK_BREAKPOINT
 #define SET_WHY_STOP(s)
 
 #endif
 
 
-#if USE_PASTI
-
-#define PREPARE_EVENT_CHECK_FOR_PASTI       \
-  if ((time_of_next_event-pasti_update_time) >= 0){                 \
-    time_of_next_event=pasti_update_time;  \
-    event_vector=event_pasti_update;                    \
-  }
-
-#else
-
-#define PREPARE_EVENT_CHECK_FOR_PASTI
-
-#endif
-
-
-#define PREPARE_EVENT_CHECK_FOR_FLOPPY       \
-  if ((time_of_next_event-Fdc.update_time) >= 0){                 \
-    time_of_next_event=Fdc.update_time;  \
-    event_vector=event_wd1772;                    \
-  }\
-  else if ((time_of_next_event-FloppyDrive[0].time_of_next_ip) >= 0){                 \
-    time_of_next_event=FloppyDrive[0].time_of_next_ip;  \
-    event_vector=event_driveA_ip;                    \
-  }\
-  else if ((time_of_next_event-FloppyDrive[1].time_of_next_ip) >= 0){                 \
-    time_of_next_event=FloppyDrive[1].time_of_next_ip;  \
-    event_vector=event_driveB_ip;                    \
-  }
-
-
-#define PREPARE_EVENT_CHECK_FOR_ACIA \
-  if(OPTION_C1 && time_of_next_event-time_of_event_acia>=0)\
-  {\
-    time_of_next_event=time_of_event_acia;\
-    event_vector=event_acia;\
-  }
-
-
 typedef void(*EVENTPROC)();
 
 #pragma pack(push, 8)
@@ -138,5 +138,6 @@ extern DWORD ste_sound_channel_buf_len;
 extern DWORD ste_sound_channel_buf_idx;
 extern const WORD ste_sound_mode_to_freq[4];
 extern int ste_sound_output_countdown,ste_sound_samples_countdown;
+void ste_sound_output(WORD w1,WORD w2,int steps);
 
 #endif//define SSESHIFTER_H
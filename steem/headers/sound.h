@@ -27,10 +27,15 @@ struct TLMC1992
 #define INITSOUND_DECLA_H
 
 #include <easystr.h>
+#include <parameters.h>
 #include <dsp/dsp.h>
+#include <benchmark.h>
 #ifdef WIN32
 #include <dsound.h>
 #endif
+#ifdef UNIX
+#include "../../thread.h" // ring indices shared with the audio thread
+#endif
 
 #define DEFAULT_SOUND_BUFFER_LENGTH (32768*SCREENS_PER_SOUND_VBL)
 #define PSG_BUF_LENGTH sound_buffer_length
@@ -133,14 +138,41 @@ extern int rt_unsigned_8bit;
 #define RT_ONLY(s)
 #endif
 
+#ifdef STEEM_BENCH
+// null backend of the headless benchmark, consumes samples at emulated speed
+#define XS_NULL 3
+#define NULL_ONLY(s) s
+HRESULT Null_Init();
+DWORD Null_GetTime();
+void Null_Release();
+HRESULT Null_StartBuffer(int flatlevel1,int flatlevel2);
+bool Null_IsPlaying();
+HRESULT Null_Stop(bool Immediate);
+#else
+#define NULL_ONLY(s)
+#endif
+
 extern int x_sound_lib;
 extern EasyStr sound_device_name;
 extern int console_device;
-extern int sound_buf_pointer;
+extern thread_atomic_int_t sound_buf_pointer; // sample count, audio thread
 extern EasyStr sound_device_name; // INIT("/dev/dsp");
 extern int console_device,x_sound_lib;
 extern BYTE x_sound_buf[X_SOUND_BUF_LEN_BYTES+16];
 
+#if defined(SSE_SOUND_ADAPTIVE_LATENCY)
+/*  x_sound_buf is a single producer (Sound_VBL), single consumer (audio
+    callback) ring. The producer publishes the end of its data in
+    sound_buf_written, the consumer advances sound_buf_pointer. Each index
+    has one writer, so no lock, just the atomics of thread.h.
+    Published samples are final: Sound_VBL() writes a filler past the start
+    of the next VBL, but only publishes up to that start.
+*/
+extern thread_atomic_int_t sound_buf_written; // sample count
+extern thread_atomic_int_t x_sound_underrun; // samples played without data
+void XSoundRead(BYTE *pOutBuf,DWORD Samples,bool FlipSign);
+#endif
+
 #endif//UNIX
 
 
@@ -163,6 +195,12 @@ extern DWORD psg_time_of_start_of_buffer;
 extern DWORD psg_time_of_last_vbl_for_writing,psg_time_of_next_vbl_for_writing;
 extern int psg_n_samples_this_vbl;
 extern int sound_freq,sound_comline_freq,sound_chosen_freq;
+#if defined(SSE_SOUND_DRC)
+extern int sound_freq_drc;
+#define SOUND_EMU_FREQ sound_freq_drc // samples per emulated second
+#else
+#define SOUND_EMU_FREQ sound_freq
+#endif
 extern DWORD sound_record_start_time; //by timer variable = timeGetTime()
 extern int psg_write_n_screens_ahead;
 extern int MaxVolume;
@@ -193,7 +231,10 @@ extern BYTE sound_time_method ;
 
 
 struct TLMC1992 {
-  void Process(int channel,int &val);
+  enum {LIVE,RECORD,NSTREAMS,BLOCK_FRAMES=256};
+  // frames are interleaved L,R; each stream (live sound, WAV recording) has
+  // its own filter state
+  void Process(int *frames,int count,int stream=LIVE);
   void Reset(bool Cold);
   COUNTER_VAR StartTime;
   WORD Mask,Data;
@@ -202,10 +243,103 @@ struct TLMC1992 {
   BYTE treble;
   BYTE volume_l,volume_r;
   BYTE top_val_l,top_val_r;
-  TIirLowShelf MicrowireBass[2];
-  TIirHighShelf MicrowireTreble[2];
-  TIirVolume MicrowireVolume[2];
+  TIirTone Tone[NSTREAMS];
+  // what the coefficients were computed for
+  double tone_sample_rate;
+  BYTE tone_bass,tone_treble;
+  BYTE gain_volume,gain_volume_l,gain_volume_r;
+  float gain_l,gain_r;
   BYTE old_top_val_l,old_top_val_r;
 };
 
+
+#if defined(SSE_SOUND_ADAPTIVE_LATENCY)
+/*  How far ahead of the play cursor Sound_VBL() writes, in samples.
+    It starts at the option (psg_write_n_screens_ahead screens), which is also
+    the maximum. On an underrun it goes up half a screen, while the lowest
+    fill of the last WINDOW VBLs leaves a margin it goes down, to one screen
+    plus what the output device consumes at once.
+*/
+
+struct TSoundLatency {
+  enum {WINDOW=64};
+  void Reset();
+  int Update(DWORD s_time,DWORD data_end,int samples_per_vbl,bool underrun);
+  int Target;
+  int MinFill,MaxJitter;
+  DWORD LastTime;
+  int nVbl;
+};
+
+extern TSoundLatency SoundLatency;
+
+#endif
+
+
+#if defined(SSE_SOUND_DRC)
+/*  Dynamic rate control. The emulation and the sound card don't run on the
+    same clock (the CRT thread paces frames on the monitor's refresh, the
+    card on its crystal), so the data written ahead of the play cursor slowly
+    grows or shrinks. Instead of jumping when it's too far off, the emulated
+    sound is produced at a rate a little higher or lower than sound_freq
+    (sound_freq_drc, at most MAX_PPM off), depending on how far the write
+    position is from where it should be. The pitch change is inaudible.
+*/
+
+struct TSoundDrc {
+  enum {MAX_PPM=5000,SMOOTHING=16};
+  void Reset();
+  void Update(int error,int samples_per_vbl);
+  int SamplesThisVbl(int video_freq);
+  double Error; // samples, filtered
+  int Ppm;
+  int Frac;
+};
+
+extern TSoundDrc SoundDrc;
+
+#endif
+
+
+#if defined(SSE_SOUND_PROFILE)
+/*  Audio pipeline profiler, enabled with [Sound] Profile in the ini file
+    (1: OSD, 2: OSD + sound_profile.csv in the Steem folder).
+    The hot paths are timed with BENCH_SCOPE and the sound stages of
+    TBenchmark (benchmark.h). Each second the time of each stage is
+    converted to microseconds against the system clock and goes to Stats,
+    the OSD and the CSV file.
+    Latency probe: a PSG volume write is timestamped with the sample it
+    affects, when Sound_VBL() hands this sample to the device we have the
+    latency to device, the samples ahead of the play cursor add the wait
+    before it's heard.
+*/
+
+struct TSoundProfile {
+  enum EMode {OFF,OSD,CSV};
+  // FUNCTIONS
+  TSoundProfile();
+  ~TSoundProfile();
+  void Reset(); // at sound start
+  void Stop(); // at sound stop
+  void ArmProbe(DWORD sample);
+  void CheckProbe(DWORD written_to,DWORD play_cursor);
+  void Vbl(); // end of Sound_VBL(), once a second aggregates
+  // DATA
+  unsigned long long StageTime[TBenchmark::NSOUNDSTAGES]; // start of second
+  unsigned long long SecondTicks,SecondUs; // start of second
+  unsigned long long ProbeTicks,ProbeDeviceTicks; // probe time, total
+  unsigned long long ProbeOutputSamples; // total
+  FILE *Csv;
+  DWORD ProbeSample;
+  int nProbes,nSeconds;
+  int DeviceUs,OutputUs; // latency, last average
+  char OsdText[OSD_MESSAGE_LENGTH+1];
+  BYTE Mode;
+  bool ProbeArmed;
+};
+
+extern TSoundProfile SoundProfile;
+
+#endif
+
 #endif//#ifndef INITSOUND_DECLA_H
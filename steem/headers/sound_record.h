@@ -0,0 +1,78 @@
+/*---------------------------------------------------------------------------
+PROJECT: Steem SSE
+Atari ST emulator
+Copyright (C) 2020 by Anthony Hayward and Russel Hayward + SSE
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see https://www.gnu.org/licenses/.
+
+DOMAIN: Sound
+FILE: sound_record.h
+DESCRIPTION: Declarations for the sound recorder, which writes the file
+on its own thread.
+struct TSoundRecorder
+---------------------------------------------------------------------------*/
+
+#pragma once
+#ifndef SOUND_RECORD_H
+#define SOUND_RECORD_H
+
+#if defined(SSE_SOUND_RECORD_THREAD)
+
+#include <stdio.h>
+#include <conditions.h>
+#include "../../thread.h"
+
+struct TFlacEncoder;
+
+struct TSoundRecordBlock {
+  enum {SIZE=32*1024};
+  int nBytes;
+  BYTE Data[SIZE];
+};
+
+
+struct TSoundRecorder {
+  enum {NBLOCKS=16}; // 512KB, about 3 seconds of 44kHz 16bit stereo
+  // FUNCTIONS
+  TSoundRecorder();
+  ~TSoundRecorder();
+  bool Start(FILE *f,int format,int freq,int channels,int bits);
+  bool Stop(); // false if the writer failed
+  void Flush();
+  void Write(const BYTE *p,int n);
+  inline void Put(BYTE b) {
+    *(Pos++)=b;
+    if(Pos==End)
+      Flush();
+  }
+  static int WriterThread(void *p);
+  int Writer();
+  // DATA
+  TSoundRecordBlock *Block[NBLOCKS];
+  TSoundRecordBlock *Current; // being filled by the emulator
+  BYTE *Pos,*End;
+  void *FullValues[NBLOCKS+1],*FreeValues[NBLOCKS];
+  thread_queue_t Full,Free; // emulator -> writer, writer -> emulator
+  thread_ptr_t Thread;
+  FILE *File;
+  TFlacEncoder *Flac;
+  int Format,Freq,nChannels,nBits;
+  bool Error;
+};
+
+extern TSoundRecorder SoundRecorder;
+
+#endif//SSE_SOUND_RECORD_THREAD
+
+#endif//SOUND_RECORD_H
@@ -64,7 +64,7 @@ DWORD PA_GetTime() {
   if(sound_time_method<2)
   {
    // return DWORD(Pa_GetStreamTime(pa_out)-pa_start_time);
-   return sound_buf_pointer;
+   return thread_atomic_int_load(&sound_buf_pointer);
   }
   else
   {
@@ -137,7 +137,7 @@ HRESULT PA_StartBuffer(int flatlevel1,int flatlevel2) {
     return DSERR_GENERIC;
   }
   pa_start_time=Pa_GetStreamTime(pa_out);
-  sound_buf_pointer=0;// sample count
+  thread_atomic_int_store(&sound_buf_pointer,0);// sample count
   WIN_ONLY( DSOpen=true; )
   return DS_OK;
 }
@@ -147,8 +147,12 @@ int PA_Callback(const void*,void *pOutBuf,unsigned long bufferSize, const
                 PaStreamCallbackTimeInfo* OutTime,PaStreamCallbackFlags,void*) {
   if(pOutBuf==NULL || !bufferSize || !sound_buffer_length) 
     return 0;
+#if defined(SSE_SOUND_ADAPTIVE_LATENCY)
+  XSoundRead((BYTE*)pOutBuf,bufferSize,true);
+#else
   char *buffer=(char*)pOutBuf;
-  int pointer_byte=sound_buf_pointer;
+  int pointer=thread_atomic_int_load(&sound_buf_pointer);
+  int pointer_byte=pointer;
   pointer_byte%=sound_buffer_length; // Get sample count within buffer
   pointer_byte*=sound_bytes_per_sample; // Convert to bytes
   for(DWORD i=0;i<bufferSize;i++)
@@ -163,8 +167,9 @@ int PA_Callback(const void*,void *pOutBuf,unsigned long bufferSize, const
         pointer_byte-=X_SOUND_BUF_LEN_BYTES;
       buffer++;
     }
-    sound_buf_pointer++;
   }
+  thread_atomic_int_store(&sound_buf_pointer,pointer+(int)bufferSize);
+#endif
   return paContinue;
 }
 
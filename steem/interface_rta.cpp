@@ -70,7 +70,7 @@ HRESULT Rt_Init() {
 
 
 DWORD Rt_GetTime() {
-  return sound_buf_pointer;
+  return thread_atomic_int_load(&sound_buf_pointer);
 }
 
 
@@ -132,7 +132,7 @@ HRESULT Rt_StartBuffer(int flatlevel1,int flatlevel2) {
   }
   sound_buffer_length=X_SOUND_BUF_LEN_BYTES/sound_bytes_per_sample;
   XSoundInitBuffer(flatlevel1,flatlevel2);
-  sound_buf_pointer=0; // sample count
+  thread_atomic_int_store(&sound_buf_pointer,0); // sample count
   try {
     rt_audio->startStream();
   }
@@ -157,8 +157,12 @@ HRESULT Rt_StartBuffer(int flatlevel1,int flatlevel2) {
 
 int Rt_Callback(void *pOutBuf, void*, unsigned int bufferSize, double, 
                 RtAudioStreamStatus, void*) {
+#if defined(SSE_SOUND_ADAPTIVE_LATENCY)
+  XSoundRead((BYTE*)pOutBuf,bufferSize,!rt_unsigned_8bit);
+#else
   char *buffer=(char*)pOutBuf;
-  int pointer_byte=sound_buf_pointer;
+  int pointer=thread_atomic_int_load(&sound_buf_pointer);
+  int pointer_byte=pointer;
   pointer_byte%=sound_buffer_length; // Get sample count within buffer
   pointer_byte*=sound_bytes_per_sample; // Convert to bytes
   for(DWORD i=0;i<bufferSize;i++)
@@ -173,8 +177,9 @@ int Rt_Callback(void *pOutBuf, void*, unsigned int bufferSize, double,
         pointer_byte-=X_SOUND_BUF_LEN_BYTES;
       buffer++;
     }
-    sound_buf_pointer++;
   }
+  thread_atomic_int_store(&sound_buf_pointer,pointer+(int)bufferSize);
+#endif
   return 0; // value for OK
 }
 
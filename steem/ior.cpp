@@ -43,6 +43,7 @@ This file handles reading from device registers.
 #define LOGSECTION LOGSECTION_IO
 
 WORD io_read(MEM_ADDRESS addr) {
+  IDLE_LOOP_IMPURE // value may depend on time
 #ifdef DEBUG_BUILD
   DEBUG_CHECK_READ_IO_W(addr);
 #endif
@@ -127,6 +127,7 @@ void io_write(MEM_ADDRESS addr, DU16 uio_src_w) {
           Mmu.Confused=false;
         }
 #endif
+        MMU_UPDATE_PAGE_TABLE
         TRACE_LOG("MMU PC %X Byte %X RAM %dK Bank 0 %d Bank 1 %d confused %d\n",
           old_pc,lobyte,mem_len/1024,SSEConfig.bank_length[0]/1024,SSEConfig.bank_length[1]/1024,Mmu.Confused);
       }
@@ -1601,7 +1602,10 @@ read until a write is performed.
     else if(offset==0)
     {
       if(io_src_w<=8) // max 8MB
+      {
         Mmu.MonSTerHimem=(4+io_src_w)*0x100000;
+        MMU_UPDATE_PAGE_TABLE
+      }
     }
     break;
   }
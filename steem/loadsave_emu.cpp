@@ -1205,6 +1205,7 @@ int LoadSaveAllStuff(FILE *f,bool LoadOrSave,int Version,
 
 
 void LoadSnapShotUpdateVars(int Version) {
+  MMU_UPDATE_PAGE_TABLE // before the first fetch
   SET_PC(pc);
   if(Version>=59) //395-400
   {
@@ -64,6 +64,7 @@ GUI objects instantiated.
 #include <patchesbox.h>
 #include <macros.h>
 #include <key_table.h>
+#include <benchmark.h>
 #if defined(SSE_MAIN_LOOP3)
 #include <eh.h>
 #include <psapi.h>
@@ -355,6 +356,10 @@ int WINAPI WinMain(HINSTANCE ourInstance,HINSTANCE,char *,int) {
 int main(int argc,char *argv[]) {
   _argv=argv;
   _argc=argc;
+#if defined(STEEM_BENCH)
+  // headless: no X display, no sound device, no GUI
+  return Bench.Main(argc,argv);
+#endif
   for(int n=0;n<_argc-1;n++) 
   {
     EasyStr butt;
@@ -933,6 +938,9 @@ your settings, anything you change this time will be saved to steemcrash.ini)"),
   SetNotifyInitText(T("Jump Tables"));
   DBG_LOG("STARTUP: cpu_routines_init Called");
   cpu_routines_init();
+#if defined(SSE_CPU_SPECIALISED_TIMING)
+  ChangeTimingFunctions(); // install the handlers for the current model
+#endif
 #if defined(SSE_ARCHIVEACCESS_SUPPORT)
   SetNotifyInitText(ARCHIVEACCESS_DLL);
   WIN_ONLY( ARCHIVEACCESS_OK=LoadArchiveAccessDll(ARCHIVEACCESS_DLL); )
@@ -1805,7 +1813,7 @@ void ParseCommandLine(int NumArgs,char *Arg[],int Level) {
       else
         Disp.SaveScreenShot();
       break;
-    case ARG_SETPABUFSIZE:  UNIX_ONLY(pa_output_buffer_size=atoi(Path); ) break;
+    case ARG_SETPABUFSIZE:  UNIX_ONLY( PA_ONLY(pa_output_buffer_size=atoi(Path); ) ) break;
     case ARG_ALLOWREADOPEN: stemdos_comline_read_is_rb=true; break;
     case ARG_NOINTS:        no_ints=true; break; // SS removed _
     case ARG_STFMBORDER:
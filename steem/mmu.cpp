@@ -229,6 +229,57 @@ void mmu_confused_dpoke_abus(WORD x) {
     DPEEK(c_ad)=x;
 }
 
+
+#if defined(SSE_MMU_PAGE_TABLE)
+
+/*  Read functions (m68k_peek...) first look up the page of the address.
+    If it has a host base, the access can't cause an exception nor have a
+    side effect and is done at once, else the full address decoding is done.
+    Page 0 isn't direct because of the supervisor-only area, nor are IO,
+    cartridge (MV16), partial pages and the 'confused' MMU case.
+    The table must be updated when himem, the MMU configuration, the TOS or
+    the ST model change.
+*/
+
+BYTE *mmu_page_base[MMU_N_PAGES];
+
+void mmu_update_page_table() {
+  ZeroMemory(mmu_page_base,sizeof(mmu_page_base));
+  if(STMem==NULL)
+    return;
+  for(MEM_ADDRESS page=1;page<MMU_N_PAGES;page++)
+  {
+    MEM_ADDRESS ad=page<<MMU_PAGE_SHIFT;
+    MEM_ADDRESS ad_end=ad+(1<<MMU_PAGE_SHIFT);
+    if(ad_end<=FOUR_MEGS)
+    {
+      if(!Mmu.Confused && ad_end<=himem)
+#if defined(BIG_ENDIAN_PROCESSOR)
+        mmu_page_base[page]=STMem;
+#else
+        mmu_page_base[page]=Mem_End_minus_2;
+#endif
+    }
+#if defined(SSE_MMU_MONSTER_ALT_RAM)
+    else if(ad_end<=Mmu.MonSTerHimem)
+#if defined(BIG_ENDIAN_PROCESSOR)
+      mmu_page_base[page]=STMem;
+#else
+      mmu_page_base[page]=Mem_End_minus_2;
+#endif
+#endif
+    else if(STRom && ad>=rom_addr && ad_end<=rom_addr+tos_len
+      && (IS_STE ? (ad>=0xE00000 && ad_end<=0xEC0000) : ad_end<=rom_addr_end))
+#if defined(BIG_ENDIAN_PROCESSOR)
+      mmu_page_base[page]=STRom-rom_addr;
+#else
+      mmu_page_base[page]=Rom_End_minus_2+rom_addr;
+#endif
+  }
+}
+
+#endif
+
 #undef LOGSECTION
 
 
@@ -326,23 +377,10 @@ void TMmu::sound_set_control(BYTE io_src_b) {
         else //stereo, 1 word per sample
           ste_sound_samples_countdown+=ste_sound_freq
           *scanline_time_in_cpu_cycles_at_start_of_vbl;
-        int loop=int(Mono?2:1);
-        while(ste_sound_samples_countdown>=0)
-        {
-          for(int i=0;i<loop;i++)
-          {
-            ste_sound_output_countdown+=sound_freq;
-            while(ste_sound_output_countdown>=0)
-            {
-              if(ste_sound_channel_buf_idx>=STE_SOUND_BUFFER_LENGTH)
-                break;
-              ste_sound_channel_buf[ste_sound_channel_buf_idx++]=w1;
-              ste_sound_channel_buf[ste_sound_channel_buf_idx++]=w2;
-              ste_sound_output_countdown-=ste_sound_freq;
-            }
-          }
-          ste_sound_samples_countdown-=n_cpu_cycles_per_second;
-        }
+        int nwords=(ste_sound_samples_countdown>=0)
+          ? ste_sound_samples_countdown/(int)n_cpu_cycles_per_second+1 : 0;
+        ste_sound_samples_countdown-=nwords*(int)n_cpu_cycles_per_second;
+        ste_sound_output(w1,w2,nwords*(Mono?2:1)); // same word all along
       }
       ste_sound_on_this_screen=1;
     }//if(ste_sound_on_this_screen==0)
@@ -443,6 +481,7 @@ void TMmu::sound_fetch() {
 */
 
 void mv16_fetch(WORD data) {
+  IDLE_LOOP_IMPURE
 #define last_write Microwire.StartTime //recycle an int, starts at 0
   if(SSEConfig.mr16)
     data>>=1;
@@ -450,7 +489,7 @@ void mv16_fetch(WORD data) {
   ste_sound_samples_countdown+=ste_sound_freq*cycles; // this implies jitter
   while(ste_sound_samples_countdown>/*=*/0)
   {
-    ste_sound_output_countdown+=sound_freq;
+    ste_sound_output_countdown+=SOUND_EMU_FREQ;
     while(ste_sound_output_countdown>=0)
     {
       if(ste_sound_channel_buf_idx>=STE_SOUND_BUFFER_LENGTH)
@@ -458,7 +497,7 @@ void mv16_fetch(WORD data) {
       ste_sound_channel_buf[ste_sound_channel_buf_idx++]=ste_sound_last_word;
       ste_sound_output_countdown-=ste_sound_freq;
     }
-    ste_sound_output_countdown+=sound_freq;
+    ste_sound_output_countdown+=SOUND_EMU_FREQ;
     ste_sound_samples_countdown-=n_cpu_cycles_per_second; 
   }
   last_write=ACT;
@@ -479,6 +518,7 @@ void TMmu::Reset(bool Cold) {
   // the MMU has no reset pin so it's rather virtual here...
   ExtraBytesForHscroll=0;
   MonSTerHimem=0;
+  MMU_UPDATE_PAGE_TABLE
   vbase=Mmu.VideoCounter=shifter_draw_pointer=0;//v4 "reset:  all zeros"
   sound_control=0;
   ste_sound_start=0,next_ste_sound_start=0;
@@ -542,6 +582,7 @@ MEM_ADDRESS shifter_draw_pointer_at_start_of_line;
 #define LOGSECTION LOGSECTION_VIDEO
 
 void TMmu::UpdateVideoCounter(short CyclesIn) {
+  IDLE_LOOP_IMPURE // CPU reading the video bus
   MEM_ADDRESS vc;
   if(bad_drawing)
   {  // Fake SDP, eg extended monitor
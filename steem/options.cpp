@@ -249,6 +249,7 @@ void TConfig::make_Mem(BYTE conf0,BYTE conf1) {
     himem=FOUR_MEGS; //alt-RAM needs to be activated
 #endif
   Mmu.Confused=false;
+  MMU_UPDATE_PAGE_TABLE
   //TRACE("make_Mem %X %X mmu %X len %X himem %X\n",conf0,conf1,Mmu.MemConfig,mem_len,himem);
 }
 
@@ -2250,10 +2251,14 @@ LRESULT CALLBACK TOptionBox::WndProc(HWND Win,UINT Mess,WPARAM wPar,
       {
         SendMessage(HWND(lPar),BM_SETCHECK,1,true);
         EnableAllWindows(0,Win);
-        char wildcard[6]="*.wav";
-        if(OPTION_SOUND_RECORD_FORMAT)
+        char wildcard[7]="*.wav";
+        if(OPTION_SOUND_RECORD_FORMAT==TOption::SoundFormatYm)
           strcpy(wildcard,"*.ym");
-        char filetype[6+5];
+#if defined(SSE_SOUND_RECORD_THREAD)
+        else if(OPTION_SOUND_RECORD_FORMAT==TOption::SoundFormatFlac)
+          strcpy(wildcard,"*.flac");
+#endif
+        char filetype[7+5];
         sprintf(filetype,"%s File",wildcard+2);
         EasyStr NewWAV=FileSelect(HWND(FullScreen?StemWin:Win),
           T("Choose Sound Output File"),
@@ -3111,6 +3111,9 @@ void TOptionBox::CreateSoundPage() {
   Offset+=80;
   SendMessage(Win,CB_ADDSTRING,0,(LPARAM)CStrT("Wav"));
   SendMessage(Win,CB_ADDSTRING,0,(LPARAM)CStrT("YM"));
+#if defined(SSE_SOUND_RECORD_THREAD)
+  SendMessage(Win,CB_ADDSTRING,0,(LPARAM)CStrT("FLAC"));
+#endif
   SendMessage(Win,CB_SETCURSEL,OPTION_SOUND_RECORD_FORMAT,0);
   Wid=GetCheckBoxSize(Font,T("Warn before overwrite")).Width;
   Win=CreateWindow("Button",T("Warn before overwrite"),WS_CHILD|WS_TABSTOP|
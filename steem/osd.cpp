@@ -232,6 +232,10 @@ void osd_draw() {
     s=s%60;
     TRACE_OSD2("%02d:%02d:%02d",h,m,s);
   }
+#endif
+#if defined(SSE_SOUND_PROFILE)
+  if(SoundProfile.Mode && SoundProfile.OsdText[0])
+    TRACE_OSD2("%s",SoundProfile.OsdText);
 #endif
   int x1,y1;
   x1=draw_blit_source_rect.right-draw_blit_source_rect.left;
@@ -251,6 +255,8 @@ void osd_draw() {
 #ifdef WIN32 //TODO   
   if(!SSEConfig.IsInit)
   {
+    if(draw_grille_black<4) 
+      draw_grille_black=4;
     const BYTE nlines=4;
     EasyStr advice[nlines];
     int line=0;
@@ -581,6 +587,8 @@ void osd_draw() {
     // Hard disk activity
     if(HDDisplayTimer>timer)
     {
+      if(draw_grille_black<4) 
+        draw_grille_black=4;
       int idx=32,w=20;
       if(draw_blit_source_rect.bottom>200+BORDER_TOP+BORDER_BOTTOM)
         idx=37,w=32;
@@ -174,6 +174,7 @@ extern int random(int);
 #include <X11/Xatom.h>
 #include <X11/cursorfont.h>
 #include <X11/keysym.h>
+#include <X11/Xmd.h> // BOOL, BYTE
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -194,7 +195,9 @@ extern int random(int);
 #include <sys/shm.h>
 //#ifdef __cplusplus
 #include <X11/extensions/XShm.h>
+#if !defined(NO_XVIDMODE)
 #include <X11/extensions/xf86vmode.h>
+#endif
 //#endif
 #else
 #define NO_SHM
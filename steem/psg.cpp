@@ -247,6 +247,7 @@ const int psg_envelope_level[8][64]={
 void psg_write_buffer(int abc,DWORD to_t) {
   if(!SSEConfig.YmSoundOn)
     return;
+  BENCH_SCOPE(PSG);
   //buffer starts at time time_of_last_vbl
   //we've written up to psg_buf_pointer[abc]
   //so start at pointer and write to to_t,
@@ -496,6 +497,10 @@ void psg_set_reg(int reg,BYTE old_val,BYTE &new_val) {
   a64/=cpu_cycles_per_vbl; //SS eg 160420
   DWORD t=psg_time_of_last_vbl_for_writing+(DWORD)a64; //SS t's unit is #samples (total)
   DBG_LOG(EasyStr("SOUND: PSG reg ")+reg+" changed to "+new_val+" at "+scanline_cycle_log()+"; samples "+t+"; vbl was at "+psg_time_of_last_vbl_for_writing);
+#if defined(SSE_SOUND_PROFILE)
+  if(SoundProfile.Mode && reg>=PSGR_AMPLITUDE_A && reg<=PSGR_AMPLITUDE_C)
+    SoundProfile.ArmProbe(t); // a volume change is heard at once
+#endif
 #if defined(SSE_YM2149_LL)
   if(OPTION_MAME_YM)
   {
@@ -592,6 +597,22 @@ void psg_set_reg(int reg,BYTE old_val,BYTE &new_val) {
 #undef LOGSECTION
 
 
+#if defined(SSE_YM2149_MIX_TABLE)
+/*  Measured volumes of the three voices [C][B][A] (Paulo Simoes). It was
+    read from ym2149_fixed_vol.bin or from the resource, it's in the code
+    now.
+*/
+static const WORD ym2149_fixed_vol[16][16][16]=
+#include <various/ym2149_fixed_vol.h>
+
+/*  Same as p_fixed_vol_3voices for the 5bit levels of the envelope, built
+    by LoadFixedVolTable(). For an even envelope step, it's the geometric
+    mean of this level and the one below, that was computed with sqrt() at
+    each sample. A voice not on the envelope has level volume*2+1.
+    Not in TYM2149 because the struct is saved in snapshots.
+*/
+static WORD ym2149_mix_3voices[32*32*32];
+#endif
 
 #define ENVELOPE_MASK 31
 
@@ -625,6 +646,10 @@ bool TYM2149::LoadFixedVolTable(bool check_dmamix) {
   FreeFixedVolTable();
   p_fixed_vol_3voices=new WORD[16*16*16];
   //ASSERT(p_fixed_vol_3voices);
+#if defined(SSE_YM2149_MIX_TABLE)
+  memcpy(p_fixed_vol_3voices,ym2149_fixed_vol,sizeof(ym2149_fixed_vol));
+  ok=true;
+#else
   // first look for the file, if it isn't there, use internal resource
   EasyStr filename=RunDir+SLASH+SSE_PLUGIN_DIR1+SLASH+YM2149_FIXED_VOL_FILENAME;
   FILE *fp=fopen(filename.Text,"r+b");
@@ -668,6 +693,7 @@ bool TYM2149::LoadFixedVolTable(bool check_dmamix) {
     }
   }
 #endif  
+#endif//SSE_YM2149_MIX_TABLE
 #if defined(SSE_SOUND_16BIT_CENTRED)
 /*  In previous versions, the zero (silence) was a very negative value,
     for sampled YM as well as for 'Steem native'.
@@ -697,6 +723,28 @@ TODO: shift on the fly to keep precision when interpolating?
   }
   for(int i=0;i<16*16*16;i++)
     p_fixed_vol_3voices[i]>>=shift; 
+#endif
+#if defined(SSE_YM2149_MIX_TABLE)
+  BYTE index[32],down[32]; // 4bit volume, 1 if interpolated with the one below
+  for(int level=0;level<32;level++)
+  {
+    index[level]=(BYTE)(level>>1);
+    down[level]=(!(level&1) && index[level]>0) ? 1 : 0;
+  }
+  WORD *pmix=ym2149_mix_3voices;
+  for(int c=0;c<32;c++)
+    for(int b=0;b<32;b++)
+      for(int a=0;a<32;a++)
+      {
+        int vol=p_fixed_vol_3voices[(16*16)*index[c]+16*index[b]+index[a]];
+        if(down[a]|down[b]|down[c])
+        {
+          int vol2=p_fixed_vol_3voices[(16*16)*(index[c]-down[c])
+            +16*(index[b]-down[b])+(index[a]-down[a])];
+          vol=(int)sqrt((float)vol * (float)vol2);
+        }
+        *pmix++=(WORD)vol;
+      }
 #endif
   SSEConfig.ym2149_fixed_vol=ok;
   return ok;
@@ -794,11 +842,23 @@ void TYM2149::Reset() {
 #define ENVELOPE_PERIOD()       ((psg_reg[PSGR_ENVELOPE_PERIOD_LOW] \
   | (psg_reg[PSGR_ENVELOPE_PERIOD_HIGH]<<8)))
 
+#if defined(STEEM_BENCH) || defined(SSE_SOUND_PROFILE)
+// The filter runs at each transition, too often for a scope: its ticks are
+// summed and charged to ANTIALIAS once per call.
+#define FILTER_TIME_START if(time_filter) filter_start=TBenchmark::Now()
+#define FILTER_TIME_STOP \
+  if(time_filter) filter_ticks+=TBenchmark::Now()-filter_start
+#else
+#define FILTER_TIME_START
+#define FILTER_TIME_STOP
+#endif
+
 void TYM2149::psg_write_buffer(DWORD to_t, bool vbl) {
   //ASSERT(OPTION_MAME_YM);
 
   if(!psg_n_samples_this_vbl||!SSEConfig.YmSoundOn)
     return;
+  BENCH_SCOPE(PSG);
 
   // compute #samples at our current sample rate
   DWORD t=(psg_time_of_last_vbl_for_writing+psg_buf_pointer[0]);
@@ -834,6 +894,10 @@ void TYM2149::psg_write_buffer(DWORD to_t, bool vbl) {
     if(cycles_to_run<=0)
       return;
   }
+#if defined(STEEM_BENCH) || defined(SSE_SOUND_PROFILE)
+  bool time_filter=(AntiAlias && Bench.Active);
+  unsigned long long filter_ticks=0,filter_start=0;
+#endif
 
 /*  The following was inspired by MAME project, especially ay8910.cpp.
     thx Couriersud.
@@ -841,6 +905,11 @@ void TYM2149::psg_write_buffer(DWORD to_t, bool vbl) {
     show that it uses more CPU than Steem's way (PREPARE, ADVANCE...), a good
     deal of that is used by the antialiasing filter.
     We take advantage of more powerful computers...
+    Registers don't change during a call, so between two events (tone edge,
+    noise or envelope step) nothing changes: those ticks are skipped, the
+    counters advanced at once. The output is then a series of steps, the
+    filter gets only those (BLEP, see filt.cpp) and is computed when a sample
+    is sent. The cost follows the transitions rather than the 250Khz clock.
 */
 
   /* The 8910 has three outputs, each output is the mix of one of the three */
@@ -857,6 +926,35 @@ void TYM2149::psg_write_buffer(DWORD to_t, bool vbl) {
     (AntiAlias&&!vbl)?(i<cycles_to_run):
     count;i+=8)
   {
+    // ticks to the next event or the next sample sent, the ticks before it
+    // change no output and are skipped
+    int run=(AntiAlias&&!vbl) ? (int)((cycles_to_run-i+7)/8) : INT_MAX;
+    COUNTER_VAR to_next_sample=(time_to_send_next_sample-m_cycles+7)/8;
+    if(to_next_sample<run)
+      run=MAX((int)to_next_sample,1);
+    run=MIN(run,MAX((psg_reg[PSGR_NOISE_PERIOD] & 0x1f)-m_count_noise,1));
+    if(m_holding==0)
+      run=MIN(run,MAX((int)ENVELOPE_PERIOD()-m_count_env,1));
+    for(int abc=0;abc<3;abc++)
+      run=MIN(run,MAX(TONE_PERIOD(abc)-m_count[abc],1));
+    if(run>1)
+    {
+      int skip=run-1;
+      m_cycles+=8*skip;
+      i+=8*skip;
+      m_count_noise+=skip;
+      if(m_holding==0)
+        m_count_env+=skip;
+      for(int abc=0;abc<3;abc++)
+        m_count[abc]+=skip;
+      if(AntiAlias)
+      {
+        FILTER_TIME_START;
+        AntiAlias->advance(skip);
+        FILTER_TIME_STOP;
+      }
+    }
+
     m_cycles+=8;  //the driver is clocked with clock / 8  (250Khz)
 
     //SS We compute noise then envelope, then we compute each tone and
@@ -924,8 +1022,12 @@ void TYM2149::psg_write_buffer(DWORD to_t, bool vbl) {
     //ASSERT(m_env_volume>=0 && m_env_volume<32);
 
     //as in psg's AlterV
+#if defined(SSE_YM2149_MIX_TABLE)
+    BYTE level[3];
+#else
     BYTE index[3],interpolate[4];
     *(int*)interpolate=0;
+#endif
     int vol=0;
     //TRACE_OSD("%d %d %d",TONE_PERIOD(0),TONE_PERIOD(1),TONE_PERIOD(2));
     for(int abc=0;abc<3;abc++)
@@ -963,6 +1065,11 @@ void TYM2149::psg_write_buffer(DWORD to_t, bool vbl) {
       else
         digit |=(psg_reg[abc+8] & 15)<<1; // vol 4bit shifted
 
+#if defined(SSE_YM2149_MIX_TABLE)
+      level[abc]=(digit&BIT_6) ? (digit&31) : (digit|1); // 5bit
+    }//nxt abc
+    vol=ym2149_mix_3voices[(32*32)*level[2]+32*level[1]+level[0]];
+#else
       index[abc]=(digit >>1)&0xF; // 4bit volume
       interpolate[abc]=((digit&BIT_6) && index[abc]>0 && !(digit &1) ) ? 1 : 0;
     }//nxt abc
@@ -974,13 +1081,28 @@ void TYM2149::psg_write_buffer(DWORD to_t, bool vbl) {
         +16*(index[1]-interpolate[1])+(index[0]-interpolate[0])];
       vol=(int)sqrt((float)vol * (float)vol2);
     }
+#endif
     // Thanks to this kick-ass filter, we can avoid horrible aliasing in all
     // sample rates.
-    *p=(AntiAlias) ? (int)AntiAlias->do_sample((double)vol) : vol;
+    if(AntiAlias)
+    {
+      FILTER_TIME_START;
+      AntiAlias->advance(1);
+      AntiAlias->set_level((float)vol);
+      FILTER_TIME_STOP;
+    }
+    else
+      *p=vol;
 
     if(m_cycles-time_to_send_next_sample>=0
       && (unsigned)(p-psg_channels_buf)<=PSG_CHANNEL_BUF_LENGTH)
     {
+      if(AntiAlias)
+      {
+        FILTER_TIME_START;
+        *p=(int)AntiAlias->output();
+        FILTER_TIME_STOP;
+      }
       int copy=*p;
       *(++p)=copy; //same value, not zero
       count--;
@@ -997,6 +1119,12 @@ void TYM2149::psg_write_buffer(DWORD to_t, bool vbl) {
           +(int)(((double)samples_sent+1)*ym2149_cycles_per_sample);
     }
   }
+  if(AntiAlias) // the last value, as if filtered at each sample
+    *p=(int)AntiAlias->output();
+#if defined(STEEM_BENCH) || defined(SSE_SOUND_PROFILE)
+  if(time_filter)
+    Bench.Charge(TBenchmark::ANTIALIAS,filter_ticks);
+#endif
   psg_buf_pointer[0]=to_t-psg_time_of_last_vbl_for_writing;
   psg_buf_pointer[2]=psg_buf_pointer[1]=psg_buf_pointer[0];
 }
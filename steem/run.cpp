@@ -38,10 +38,12 @@ event_scanline and event_vbl_interrupt.
 #include <stjoy.h>
 #include <shortcutbox.h>
 #include <palette.h>
+#include <draw_threads.h>
 #include <translate.h>
 #include <debugger.h>
 #include <debug_framereport.h>
 #include <infobox.h>
+#include <benchmark.h>
 
 
 EVENTPROC event_mfp_timer_timeout[4]={event_timer_a_timeout,
@@ -358,7 +360,28 @@ void run() {
 }
 
 
+/*  Event sources besides video. They're checked in this order, the first
+    source with the earliest time is picked, but on equal times the last
+    one wins (it was so with the former macros).
+    To add a source, add a call to event_source() in prepare_next_event().
+    This straight pass costs about half of a table of sources with an
+    'armed' function each, and less than a binary heap, which would also
+    need an update at each of the many places deadlines are written.
+*/
+
+inline bool event_source(bool armed,COUNTER_VAR time,EVENTPROC event) {
+  if(armed && time_of_next_event-time>=0)
+  {
+    time_of_next_event=time;
+    event_vector=event;
+    return true;
+  }
+  return false;
+}
+
+
 void prepare_next_event() {
+  IDLE_LOOP_IMPURE // the event may have changed memory
   if(OPTION_C3)
   {
     event_vector=event_dummy;
@@ -366,19 +389,23 @@ void prepare_next_event() {
   }
   else
     Glue.GetNextVideoEvent();
-  // check timers for timeouts
-  PREPARE_EVENT_CHECK_FOR_TIMER_TIMEOUTS(0);
-  PREPARE_EVENT_CHECK_FOR_TIMER_TIMEOUTS(1);
-  PREPARE_EVENT_CHECK_FOR_TIMER_TIMEOUTS(2);
-  PREPARE_EVENT_CHECK_FOR_TIMER_TIMEOUTS(3);
-  if(!OPTION_C3)
-  {
-    PREPARE_EVENT_CHECK_FOR_TIMER_B;
-  }
-  PREPARE_EVENT_CHECK_FOR_DEBUG;
-  PREPARE_EVENT_CHECK_FOR_PASTI;
-  PREPARE_EVENT_CHECK_FOR_FLOPPY;
-  PREPARE_EVENT_CHECK_FOR_ACIA;
+  for(int tn=0;tn<4;tn++)
+    event_source(mfp_timer_enabled[tn] || mfp_timer_period_change[tn],
+      mfp_timer_timeout[tn],event_mfp_timer_timeout[tn]);
+  event_source(Mfp.reg[MFPR_TBCR]==8 && !OPTION_C3,time_of_next_timer_b,
+    event_timer_b);
+#ifdef DEBUG_BUILD
+  event_source(debug_run_until==DRU_CYCLE,debug_run_until_val,
+    event_debug_stop);
+#endif
+#if USE_PASTI
+  event_source(true,pasti_update_time,event_pasti_update);
+#endif
+  // index pulses only if the FDC wasn't picked
+  if(!event_source(true,Fdc.update_time,event_wd1772)
+    && !event_source(true,FloppyDrive[0].time_of_next_ip,event_driveA_ip))
+    event_source(true,FloppyDrive[1].time_of_next_ip,event_driveB_ip);
+  event_source(OPTION_C1!=0,time_of_event_acia,event_acia);
   // It is safe for events to be in past, whatever happens events
   // cannot get into a constant loop.
   // If a timer is set to shorter than the time for an MFP interrupt then it will
@@ -871,7 +898,15 @@ void event_vbl_interrupt() {
     // Rest of screen is black
     INT_PTR x=Disp.VideoMemoryEnd-draw_dest_ad-1;
     if(x>0 && x<Disp.VideoMemorySize)
+    {
+#if defined(SSE_VID_DRAW_THREADS)
+      DrawThreads.Sync();
+#endif
       ZeroMemory(draw_dest_ad,x);
+#if defined(SSE_VID_LINE_CACHE)
+      ScanlineCache.Invalidate(draw_dest_ad);
+#endif
+    }
     scanline_drawn_so_far=0;
     shifter_draw_pointer_at_start_of_line=shifter_draw_pointer;
   }
@@ -881,9 +916,15 @@ void event_vbl_interrupt() {
   if(draw_lock) 
   {
     draw_end();
-    if(VSyncing==0&&!OPTION_3BUFFER_WIN)
-      draw_blit();
-    BlitFrame=true;
+#if defined(SSE_VID_LINE_CACHE)
+    // Unchanged frame: no blit, no VSync, the timer below paces the frame
+    if(!ScanlineCache.SkipBlit())
+#endif
+    {
+      if(VSyncing==0&&!OPTION_3BUFFER_WIN)
+        draw_blit();
+      BlitFrame=true;
+    }
   }
   else if(bad_drawing&2) 
   {
@@ -893,6 +934,10 @@ void event_vbl_interrupt() {
     draw(0);
     bad_drawing&=(~2);
   }
+#if defined(STEEM_BENCH)
+  if(Bench.Active)
+    Bench.Vbl(); // count frames, stop when done
+#endif
   if(floppy_mediach[0]) 
     floppy_mediach[0]--;  //counter for media change
   if(floppy_mediach[1]) 
@@ -957,7 +1002,7 @@ void event_vbl_interrupt() {
   else if((frameskip_count<=1||fast_forward)&&!disable_speed_limiting) 
   {
     frame_delay_timeout=speed_limit_wait_till;
-    if(VSyncing)
+    if(VSyncing&&BlitFrame) // no VSync for frames we don't blit
       // Allow up to a 25% increase in run speed
       time_for_exact_limit=((run_speed_ticks_per_second+(Glue.video_freq/2))/Glue.video_freq)/4;
   }
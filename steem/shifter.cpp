@@ -47,6 +47,7 @@ is also emulated at high level.
 #include <gui.h>
 #include <sound.h>
 #include <interface_stvl.h>
+#include <benchmark.h>
 
 
 ///////////
@@ -79,6 +80,130 @@ TShifter::TShifter() {
 
 #ifdef WIN32
 
+#if defined(SSE_VID_LINE_COPY_SIMD)
+/*  Copy of the buffered scanline to video memory, on one line or two for
+    double height, in the same pass. The destination is a locked surface in
+    video memory, so we use non-temporal stores: they don't pollute the cache
+    with pixels we won't read and they fill the write-combining buffers
+    whole.
+    Stores are aligned on the first line, DWORDs are copied before and after.
+    The second line is streamed too if it has the same alignment.
+    The kernel is chosen at startup through CPUID, NULL = the DWORD loop.
+*/
+
+#include <immintrin.h>
+
+typedef void (*LPLINECOPYPROC)(DWORD *dest,const DWORD *src,int n,
+  int line2); // n DWORDs, line2 = offset of the second line in DWORDs or 0
+
+
+void line_copy_sse2(DWORD *dest,const DWORD *src,int n,int line2) {
+  for(;n && ((size_t)dest&15);n--,src++,dest++)
+  {
+    *dest=*src;
+    if(line2)
+      dest[line2]=*src;
+  }
+  if(!line2)
+  {
+    for(;n>=4;n-=4,src+=4,dest+=4)
+      _mm_stream_si128((__m128i*)dest,_mm_loadu_si128((__m128i*)src));
+  }
+  else if(!((line2*4)&15))
+  {
+    for(;n>=4;n-=4,src+=4,dest+=4)
+    {
+      __m128i px=_mm_loadu_si128((__m128i*)src);
+      _mm_stream_si128((__m128i*)dest,px);
+      _mm_stream_si128((__m128i*)(dest+line2),px);
+    }
+  }
+  else
+  {
+    for(;n>=4;n-=4,src+=4,dest+=4)
+    {
+      __m128i px=_mm_loadu_si128((__m128i*)src);
+      _mm_stream_si128((__m128i*)dest,px);
+      _mm_storeu_si128((__m128i*)(dest+line2),px);
+    }
+  }
+  for(;n;n--,src++,dest++)
+  {
+    *dest=*src;
+    if(line2)
+      dest[line2]=*src;
+  }
+  _mm_sfence(); // streamed pixels are visible before the blit
+}
+
+
+#if _MSC_VER>=1600 // VS2010 SP1
+
+void line_copy_avx(DWORD *dest,const DWORD *src,int n,int line2) {
+  for(;n && ((size_t)dest&31);n--,src++,dest++)
+  {
+    *dest=*src;
+    if(line2)
+      dest[line2]=*src;
+  }
+  if(!line2)
+  {
+    for(;n>=8;n-=8,src+=8,dest+=8)
+      _mm256_stream_si256((__m256i*)dest,_mm256_loadu_si256((__m256i*)src));
+  }
+  else if(!((line2*4)&31))
+  {
+    for(;n>=8;n-=8,src+=8,dest+=8)
+    {
+      __m256i px=_mm256_loadu_si256((__m256i*)src);
+      _mm256_stream_si256((__m256i*)dest,px);
+      _mm256_stream_si256((__m256i*)(dest+line2),px);
+    }
+  }
+  else
+  {
+    for(;n>=8;n-=8,src+=8,dest+=8)
+    {
+      __m256i px=_mm256_loadu_si256((__m256i*)src);
+      _mm256_stream_si256((__m256i*)dest,px);
+      _mm256_storeu_si256((__m256i*)(dest+line2),px);
+    }
+  }
+  _mm256_zeroupper();
+  for(;n;n--,src++,dest++)
+  {
+    *dest=*src;
+    if(line2)
+      dest[line2]=*src;
+  }
+  _mm_sfence();
+}
+
+#endif
+
+
+LPLINECOPYPROC line_copy_select() {
+  int info[4];
+  __cpuid(info,0);
+  int max_leaf=info[0];
+  if(max_leaf<1)
+    return NULL;
+  __cpuid(info,1);
+  bool sse2=((info[3]&BIT_26)!=0);
+#if _MSC_VER>=1600
+  // AVX also needs the OS to save the YMM registers (OSXSAVE, XCR0)
+  if((info[2]&BIT_27) && (info[2]&BIT_28) && ((_xgetbv(0)&6)==6))
+    return line_copy_avx;
+#endif
+  return (sse2) ? line_copy_sse2 : NULL;
+}
+
+
+LPLINECOPYPROC line_copy=line_copy_select();
+
+#endif//SSE_VID_LINE_COPY_SIMD
+
+
 void TShifter::DrawBufferedScanlineToVideo() {
   if(draw_store_dest_ad)
   { 
@@ -95,14 +220,22 @@ void TShifter::DrawBufferedScanlineToVideo() {
     // From draw_temp_line_buf to draw_store_dest_ad
     DWORD *src=(DWORD*)draw_temp_line_buf; 
     DWORD *dest=(DWORD*)draw_store_dest_ad;  
-    while(src<(DWORD*)draw_dest_ad)
-      *(dest++)=*(src++); 
-    if(draw_med_low_double_height)
+#if defined(SSE_VID_LINE_COPY_SIMD)
+    if(line_copy && amount_drawn>0 && !(draw_line_length&3))
+      line_copy(dest,src,(amount_drawn+3)/4,
+        (draw_med_low_double_height) ? draw_line_length/4 : 0);
+    else
+#endif
     {
-      src=(DWORD*)draw_temp_line_buf;                        
-      dest=(DWORD*)(draw_store_dest_ad+draw_line_length);     
-      while(src<(DWORD*)draw_dest_ad) 
-        *(dest++)=*(src++);       
+      while(src<(DWORD*)draw_dest_ad)
+        *(dest++)=*(src++); 
+      if(draw_med_low_double_height)
+      {
+        src=(DWORD*)draw_temp_line_buf;                        
+        dest=(DWORD*)(draw_store_dest_ad+draw_line_length);     
+        while(src<(DWORD*)draw_dest_ad) 
+          *(dest++)=*(src++);       
+      }
     }
     draw_dest_ad=draw_store_dest_ad+amount_drawn;                    
     draw_store_dest_ad=NULL;                                           
@@ -125,6 +258,7 @@ void TShifter::DrawBufferedScanlineToVideo() {
 
 void TShifter::DrawScanlineToEnd() {
   //ASSERT(!OPTION_C3);
+  BENCH_SCOPE(VIDEO);
   CHECK_VIDEO_RAM;
   MEM_ADDRESS nsdp;
   if(emudetect_falcon_mode!=EMUD_FALC_MODE_OFF)
@@ -293,14 +427,14 @@ void TShifter::DrawScanlineToEnd() {
         { 
           if(Glue.CurrentScanline.Tricks&TRICK_HIRES_OVERSCAN)
             ///////////////// RENDER VIDEO /////////////////
-            draw_scanline(0,640/16+BORDER_SIDE/4,0,0);
+            draw_scanline_cached(0,640/16+BORDER_SIDE/4,0,0,true);
           else
             ///////////////// RENDER VIDEO /////////////////
-            draw_scanline(BORDER_SIDE/8,640/16,BORDER_SIDE/8,0);
+            draw_scanline_cached(BORDER_SIDE/8,640/16,BORDER_SIDE/8,0,true);
         }
         else
           ///////////////// RENDER VIDEO /////////////////
-          draw_scanline(0,640/16,0,0);
+          draw_scanline_cached(0,640/16,0,0,true);
         draw_dest_ad=draw_dest_next_scanline;
         draw_dest_next_scanline+=draw_dest_increase_y;
       }
@@ -323,10 +457,11 @@ void TShifter::DrawScanlineToEnd() {
       {
         if(border)
           ///////////////// RENDER VIDEO /////////////////
-          draw_scanline((BORDER_SIDE*2+640+BORDER_SIDE*2)/16,0,0,0); // rasters!
+          draw_scanline_cached((BORDER_SIDE*2+640+BORDER_SIDE*2)/16,0,0,0,
+            true); // rasters!
         else
           ///////////////// RENDER VIDEO /////////////////
-          draw_scanline(640/16,0,0,0);
+          draw_scanline_cached(640/16,0,0,0,true);
         draw_dest_ad=draw_dest_next_scanline;
         draw_dest_next_scanline+=draw_dest_increase_y;
       }
@@ -382,6 +517,7 @@ void TShifter::IncScanline() {
 
 void TShifter::Render(short cycles_since_hbl,int dispatcher) {
   //ASSERT(!OPTION_C3);
+  BENCH_SCOPE(VIDEO);
   CHECK_VIDEO_RAM;
   if(screen_res>=2) 
     return; 
@@ -433,6 +569,9 @@ void TShifter::Render(short cycles_since_hbl,int dispatcher) {
     pixels_in+=4;
   if(pixels_in>=0) // time to render?
   {
+    // only lines drawn in one go may be cached
+    bool whole_line=(!scanline_drawn_so_far
+      && pixels_in0>=BORDER_SIDE+320+BORDER_SIDE);
 #ifdef WIN32 // prepare buffer & ASM routine
     if(pixels_in>416)
       pixels_in=pixels_in0;
@@ -564,7 +703,7 @@ void TShifter::Render(short cycles_since_hbl,int dispatcher) {
           }
           // call to appropriate ASSEMBLER routine!
           ///////////////// RENDER VIDEO /////////////////
-          draw_scanline(border1,picture,border2,hscroll); 
+          draw_scanline_cached(border1,picture,border2,hscroll,whole_line);
         }
       }
       shifter_draw_pointer=nsdp;
@@ -606,7 +745,7 @@ void TShifter::Render(short cycles_since_hbl,int dispatcher) {
         border1=(right_visible_edge - left_visible_edge);
       if(scan_y>=draw_first_possible_line && scan_y<draw_last_possible_line)
         ///////////////// RENDER VIDEO /////////////////
-        draw_scanline(border1,0,0,0);
+        draw_scanline_cached(border1,0,0,0,whole_line);
       PCpal[0]=savepal0;
     }
     scanline_drawn_so_far=pixels_in;
@@ -804,7 +943,38 @@ void TShifter::sound_get_last_sample(WORD *pw1,WORD *pw2) {
 }
 
 
+void ste_sound_output(WORD w1,WORD w2,int steps) {
+/*  Write the frames due after 'steps' DMA samples of the same value.
+    Each sample adds SOUND_EMU_FREQ and each frame takes ste_sound_freq, we
+    count them at once instead of looping, the result is the same.
+*/
+  ste_sound_output_countdown+=steps*SOUND_EMU_FREQ;
+  if(ste_sound_output_countdown<0)
+    return;
+  int n=(ste_sound_output_countdown<ste_sound_freq) ? 1
+    : ste_sound_output_countdown/ste_sound_freq+1;
+  int room=((int)STE_SOUND_BUFFER_LENGTH-(int)ste_sound_channel_buf_idx+1)/2;
+  if(n>room)
+    n=room;
+  if(n<=0)
+    return; // buffer full
+  ste_sound_output_countdown-=n*ste_sound_freq;
+  WORD *p=ste_sound_channel_buf+ste_sound_channel_buf_idx;
+  ste_sound_channel_buf_idx+=n*2;
+  while(n--)
+  {
+    *p++=w1;
+    *p++=w2;
+  }
+}
+
+
 void TShifter::sound_play() {
+/*  We count the words due this scanline first, then take them from the
+    FIFO, the format (mono/stereo, signed, host channels) is decided once.
+    When the FIFO is empty, the last word repeats: those are output in one
+    go.
+*/
   bool Mono=((shifter_sound_mode&BIT_7)!=0);
   //we want to play a/b samples, where a is the DMA sound frequency
   //and b is the number of scanlines a second
@@ -819,15 +989,15 @@ void TShifter::sound_play() {
   else //stereo, 1 word per sample
     ste_sound_samples_countdown+=ste_sound_freq*scanline_time_in_cpu_cycles_at_start_of_vbl;
   bool vol_change_l=(left_vol_top_val<128),vol_change_r=(right_vol_top_val<128);
-  while(ste_sound_samples_countdown>=0)
+  int nwords=(ste_sound_samples_countdown>=0)
+    ? ste_sound_samples_countdown/(int)n_cpu_cycles_per_second+1 : 0;
+  ste_sound_samples_countdown-=nwords*(int)n_cpu_cycles_per_second;
+  int nfifo=MIN(nwords,(int)sound_fifo_idx);
+  for(int i=0;i<nwords;i++)
   {  //play word from buffer
-    if(Shifter.sound_fifo_idx>0)
+    if(i<nfifo)
     {
-      ste_sound_last_word=Shifter.sound_fifo[0];
-      for(int i=0;i<3;i++)
-        Shifter.sound_fifo[i]
-          =Shifter.sound_fifo[i+1];
-      Shifter.sound_fifo_idx--;
+      ste_sound_last_word=sound_fifo[i];
       if(vol_change_l)
       {
         int b1=(signed char)(HIBYTE(ste_sound_last_word));
@@ -847,7 +1017,8 @@ void TShifter::sound_play() {
       if(!RENDER_SIGNED_SAMPLES)
         ste_sound_last_word^=WORD((128 << 8) | 128); // unsign
     }
-    ste_sound_output_countdown+=sound_freq;
+    // repeating the last word till the end of the line?
+    int steps=(i<nfifo) ? 1 : nwords-i;
     WORD w1,w2;
     if(Mono)
     {       //mono, play half as many words
@@ -862,23 +1033,13 @@ void TShifter::sound_play() {
         w2=WORD((ste_sound_last_word & 0x00ff) << 6);
       }
       // ste_sound_channel_buf always stereo, so put each mono sample in twice
-      while(ste_sound_output_countdown>=0)
-      {
-        if(ste_sound_channel_buf_idx>=STE_SOUND_BUFFER_LENGTH)
-          break;
-        ste_sound_channel_buf[ste_sound_channel_buf_idx++]=w1;
-        ste_sound_channel_buf[ste_sound_channel_buf_idx++]=w1;
-        ste_sound_output_countdown-=ste_sound_freq;
-      }
-      ste_sound_output_countdown+=sound_freq;
-      while(ste_sound_output_countdown>=0)
+      if(steps>1 && w1==w2)
       {
-        if(ste_sound_channel_buf_idx>=STE_SOUND_BUFFER_LENGTH)
-          break;
-        ste_sound_channel_buf[ste_sound_channel_buf_idx++]=w2;
-        ste_sound_channel_buf[ste_sound_channel_buf_idx++]=w2;
-        ste_sound_output_countdown-=ste_sound_freq;
+        ste_sound_output(w1,w1,steps*2);
+        break;
       }
+      ste_sound_output(w1,w1,1);
+      ste_sound_output(w2,w2,1);
     }
     else
     {//stereo , 1 word per sample
@@ -906,17 +1067,17 @@ void TShifter::sound_play() {
         w1=WORD((ste_sound_last_word & 0xff00) >> 2);
         w2=WORD((ste_sound_last_word & 0x00ff) << 6);
       }
-      while(ste_sound_output_countdown>=0)
-      {
-        if(ste_sound_channel_buf_idx>=STE_SOUND_BUFFER_LENGTH) 
-          break;
-        ste_sound_channel_buf[ste_sound_channel_buf_idx++]=w1;
-        ste_sound_channel_buf[ste_sound_channel_buf_idx++]=w2;
-        ste_sound_output_countdown-=ste_sound_freq;
-      }
+      ste_sound_output(w1,w2,steps);
+      if(steps>1)
+        break;
     }
-    ste_sound_samples_countdown-=n_cpu_cycles_per_second; 
-  }//while (ste_sound_samples_countdown>=0)
+  }
+  if(nfifo)
+  {
+    sound_fifo_idx-=(BYTE)nfifo;
+    for(int i=0;i<sound_fifo_idx;i++)
+      sound_fifo[i]=sound_fifo[i+nfifo];
+  }
 #if defined(SSE_VID_STVL_SREQ)
   if(OPTION_C3 && SSEConfig.Stvl>=0x101)
     Stvl.sreq=(sound_fifo_idx<4 && (Mmu.sound_control&BIT_0));
@@ -33,6 +33,8 @@ The I/O code isn't included here, see io?.cpp.
 #include <gui.h>
 #include <mymisc.h>
 #include <notifyinit.h>
+#include <benchmark.h>
+#include <sound_record.h>
 #if defined(SSE_VID_RECORD_AVI)
 #include <AVI/AviFile.h> // AVI (DD-only)
 #endif
@@ -59,6 +61,16 @@ DWORD psg_last_write_time;
 DWORD psg_time_of_start_of_buffer;
 DWORD psg_time_of_last_vbl_for_writing,psg_time_of_next_vbl_for_writing;
 int psg_n_samples_this_vbl;
+#if defined(SSE_SOUND_ADAPTIVE_LATENCY)
+TSoundLatency SoundLatency;
+#endif
+#if defined(SSE_SOUND_DRC)
+TSoundDrc SoundDrc;
+int sound_freq_drc=44100;
+#endif
+#if defined(SSE_SOUND_PROFILE)
+TSoundProfile SoundProfile;
+#endif
 #if defined(SSE_YM2149_LL)
 const WORD ym_low_pass_max=YM_LOW_PASS_MAX;
 #endif
@@ -122,8 +134,12 @@ bool DSOpen=false;
 
 EasyStr sound_device_name; // =("/dev/dsp");
 int console_device=-1;
-int sound_buf_pointer=0; // sample count
+thread_atomic_int_t sound_buf_pointer; // sample count
 BYTE x_sound_buf[X_SOUND_BUF_LEN_BYTES+16];
+#if defined(SSE_SOUND_ADAPTIVE_LATENCY)
+thread_atomic_int_t sound_buf_written;
+thread_atomic_int_t x_sound_underrun;
+#endif
 
 void XSoundInitBuffer(int,int);
 
@@ -132,6 +148,8 @@ int x_sound_lib=
   XS_RT;
 #elif !defined(NO_PORTAUDIO)
   XS_PA;
+#elif defined(STEEM_BENCH)
+  XS_NULL;
 #endif
 
 #endif//UNIX
@@ -163,6 +181,18 @@ void sound_record_open_file() {
       fputc(0,Wav_file); // Skip header (written when close)
     fprintf(Wav_file,"data    ");
   }
+#if defined(SSE_SOUND_RECORD_THREAD)
+  if(!SoundRecorder.Start(Wav_file,OPTION_SOUND_RECORD_FORMAT,sound_freq,
+    sound_num_channels,sound_num_bits))
+  {
+    fclose(Wav_file);
+    Wav_file=NULL;
+    Alert(T("Could not start sound recording"),T("Sound Recording Error"),
+      MB_ICONEXCLAMATION);
+    sound_record=false;
+    return;
+  }
+#endif
   // Need to put size of file - 44 at position 40 in file (as int in binary little endian)
   // Need to put size of file - 8 at position 4 in file (as int in binary little endian)
   // Need to put header of file at position 0x16 in file
@@ -179,6 +209,12 @@ void SaveInt(int i,FILE *f) { // was in mymisc, used only here
 void sound_record_close_file() {
   if(!Wav_file)
     return;
+#if defined(SSE_SOUND_RECORD_THREAD)
+  // the writer thread empties its queue and ends
+  if(!SoundRecorder.Stop())
+    Alert(T("Could not write the sound file"),T("Sound Recording Error"),
+      MB_ICONEXCLAMATION);
+#endif
   fflush(Wav_file);
   size_t length=ftell(Wav_file);
 /*  Convert temp file to YM3 format.
@@ -189,6 +225,10 @@ void sound_record_close_file() {
 */
   if(!length) // just in case
     ;
+#if defined(SSE_SOUND_RECORD_THREAD)
+  else if(OPTION_SOUND_RECORD_FORMAT==TOption::SoundFormatFlac)
+    ; // STREAMINFO was completed by the writer
+#endif
   else if(OPTION_SOUND_RECORD_FORMAT==TOption::SoundFormatYm)
   {
     //ASSERT(length%14==0);
@@ -368,6 +408,10 @@ HRESULT InitSound() {
 #ifndef NO_RTAUDIO
   if(x_sound_lib==XS_RT)
     Ret=Rt_Init();
+#endif
+#ifdef STEEM_BENCH
+  if(x_sound_lib==XS_NULL)
+    Ret=Null_Init();
 #endif
   if(Ret==DSERR_GENERIC)
     UseSound=0;
@@ -382,6 +426,7 @@ void SoundRelease() {
 #ifdef UNIX
   PA_ONLY( PA_Release(); )
   RT_ONLY( Rt_Release(); )
+  NULL_ONLY( Null_Release(); )
 #endif
 
   UseSound=0;
@@ -485,6 +530,7 @@ position, but the current write position cannot be changed.
 #ifdef UNIX
   PA_ONLY( if (UseSound==XS_PA) return PA_GetTime(); )
   RT_ONLY( if (UseSound==XS_RT) return Rt_GetTime(); )
+  NULL_ONLY( if (UseSound==XS_NULL) return Null_GetTime(); )
   return 0;
 #endif
 }
@@ -581,6 +627,11 @@ HRESULT SoundStartBuffer(int flatlevel1,int flatlevel2) {
   case XS_RT:
     Ret=Rt_StartBuffer(flatlevel1,flatlevel2);
     break;
+#endif
+#ifdef STEEM_BENCH
+  case XS_NULL:
+    Ret=Null_StartBuffer(flatlevel1,flatlevel2);
+    break;
 #endif
   }//sw
   if(Ret==DS_OK)
@@ -602,6 +653,7 @@ bool SoundActive() {
 #ifdef UNIX
   PA_ONLY( if (UseSound==XS_PA) return PA_IsPlaying(); )
   RT_ONLY( if (UseSound==XS_RT) return Rt_IsPlaying(); )
+  NULL_ONLY( if (UseSound==XS_NULL) return Null_IsPlaying(); )
   return 0;
 #endif
 }
@@ -610,6 +662,9 @@ bool SoundActive() {
 HRESULT Sound_Stop() {
   sound_record_close_file();
   sound_record=false;
+#if defined(SSE_SOUND_PROFILE)
+  SoundProfile.Stop();
+#endif
 #if !defined(SSE_NO_INTERNAL_SPEAKER)
   if(sound_internal_speaker) SoundStopInternalSpeaker();
 #endif
@@ -621,6 +676,7 @@ HRESULT Sound_Stop() {
 #ifdef UNIX
   PA_ONLY( if (UseSound==XS_PA) return PA_Stop(0); )
   RT_ONLY( if (UseSound==XS_RT) return Rt_Stop(0); )
+  NULL_ONLY( if (UseSound==XS_NULL) return Null_Stop(0); )
 #endif
 
 #if defined(SSE_YM2149_LL)
@@ -1106,8 +1162,52 @@ void XSoundInitBuffer(int flatlevel1,int flatlevel2) {
       }
     }
   }
+#if defined(SSE_SOUND_ADAPTIVE_LATENCY)
+  thread_atomic_int_store(&sound_buf_written,0);
+  thread_atomic_int_store(&x_sound_underrun,0);
+#endif
+}
+
+
+#if defined(SSE_SOUND_ADAPTIVE_LATENCY)
+
+void XSoundRead(BYTE *pOutBuf,DWORD Samples,bool FlipSign) {
+/*  Called by the audio thread (Rt_Callback(), PA_Callback()). Copies what
+    Sound_VBL() wrote; past the end of it, the last sample written (or the
+    flat level before the first write) is held and the underrun is counted,
+    instead of playing what was there 500ms ago.
+    The play cursor advances anyway, it's our clock.
+*/
+  int pointer=thread_atomic_int_load(&sound_buf_pointer); // only writer
+  int written=thread_atomic_int_load(&sound_buf_written);
+  DWORD n=(DWORD)MAX(MIN(written-pointer,(int)Samples),0);
+  BYTE flip=(FlipSign && sound_num_bits==8) ? 128 : 0;
+  BYTE *buffer=pOutBuf;
+  int pointer_byte=(pointer%sound_buffer_length)*sound_bytes_per_sample;
+  for(DWORD i=0;i<n;i++)
+  {
+    for(int a=0;a<sound_bytes_per_sample;a++)
+    {
+      *buffer++=x_sound_buf[pointer_byte++]^flip;
+      if(pointer_byte>=X_SOUND_BUF_LEN_BYTES)
+        pointer_byte-=X_SOUND_BUF_LEN_BYTES;
+    }
+  }
+  if(n<Samples)
+  {
+    BYTE *last=x_sound_buf+(MAX(written-1,0)%sound_buffer_length)
+      *sound_bytes_per_sample;
+    for(DWORD i=n;i<Samples;i++)
+      for(int a=0;a<sound_bytes_per_sample;a++)
+        *buffer++=last[a]^flip;
+  }
+  if(n<Samples)
+    thread_atomic_int_add(&x_sound_underrun,(int)(Samples-n));
+  thread_atomic_int_store(&sound_buf_pointer,pointer+(int)Samples);
 }
 
+#endif
+
 
 #if !defined(SSE_NO_INTERNAL_SPEAKER)
 
@@ -1155,16 +1255,177 @@ void internal_speaker_sound_by_period(int UNIX_ONLY( counter ))
     The function adds an optional low-pass filter to PSG sound and adds
     PSG and DMA sound together. (Ground for improvement).
     It also applies Microwire filters.
+    The configuration (PSG filter, bit depth, channels, STE, Microwire,
+    cartridges) can't change during a VBL, so SoundSelectKernel() picks in
+    Sound_VBL() a mixing function and a packing function specialised for it
+    at compile time. The mix goes into a block of int stereo frames, which is
+    filtered (Microwire) then packed into the sound buffer. No test and no
+    indirection is left in the loops, they can be unrolled and vectorised.
 */
 
-void WriteSoundLoop(int Alter_V, int* Out_P,int Size,int& c,int &val,
-  int &v,int &dv,int **source_p,WORD**lp_ste_sound_channel,
-  WORD**lp_max_ste_sound_channel) {
+enum ESoundMix {SOUND_MIX_RAW,SOUND_MIX_STF,SOUND_MIX_STE,SOUND_MIX_MICROWIRE,
+  SOUND_MIX_DMA_ONLY,SOUND_MIX_PROSOUND};
+
+typedef void (*PSOUNDMIX)(int *frames,int n,int &v,int &dv,int *&source_p,
+  WORD *&lp_ste_sound_channel,WORD *lp_max_ste_sound_channel);
+typedef void (*PSOUNDPACK)(const int *frames,int n,BYTE *&Out_P);
+
+struct TSoundKernel {
+  PSOUNDMIX Mix;
+  PSOUNDPACK Pack;
+  bool Microwire;
+};
+
+
+template<int Alter_V,int Mix> void SoundMix(int *frames,int n,int &v,int &dv,
+  int *&source_p,WORD *&lp_ste_sound_channel,WORD *lp_max_ste_sound_channel) {
+  int vv=v,ddv=dv; // locals so that the compiler keeps them in registers
+  int *src=source_p;
+  WORD *dma=lp_ste_sound_channel;
+  for(int i=0;i<n;i++,frames+=2)
+  {
+    if(Mix!=SOUND_MIX_DMA_ONLY) // cartridges replace the PSG
+      AlterV(Alter_V,vv,ddv,src);
+    switch(Mix) {
+    case SOUND_MIX_RAW: // 8bit, DMA samples are already scaled
+      frames[0]=vv+dma[0];
+      frames[1]=vv+dma[1];
+      break;
+    case SOUND_MIX_STF:
+      if(vv>32767)
+        vv=32767;
+      frames[0]=frames[1]=vv;
+      break;
+    case SOUND_MIX_STE:
+      frames[0]=vv+(char)dma[0]*32;
+      frames[1]=vv+(char)dma[1]*32;
+      break;
+    case SOUND_MIX_MICROWIRE:
+      frames[0]=vv+(char)dma[0]*64;
+      frames[1]=vv+(char)dma[1]*64;
+      break;
+    case SOUND_MIX_DMA_ONLY: // B.A.T's MV16 cartridge, Action Replay 16
+      frames[0]=(short)dma[0];
+      frames[1]=(short)dma[1];
+      break;
+    case SOUND_MIX_PROSOUND: // Pro Sound Designer + psg
+      frames[0]=vv+dma[0]*8;
+      frames[1]=vv+dma[1]*8;
+      break;
+    }
+    if(Mix!=SOUND_MIX_DMA_ONLY)
+    {
+      WAVEFORM_ONLY(temp_waveform_display[((int)(src-psg_channels_buf)+psg_time_of_last_vbl_for_writing) % MAX_temp_waveform_display_counter]=WORD_B_1(frames)); 
+      *src++=0;//VOLTAGE_FP(VOLTAGE_ZERO_LEVEL);
+    }
+    if(Mix!=SOUND_MIX_STF && dma<lp_max_ste_sound_channel)
+      dma+=2;
+  }
+  v=vv;
+  dv=ddv;
+  source_p=src;
+  lp_ste_sound_channel=dma;
+}
+
+
+template<int Bits,int Channels> void SoundPack(const int *frames,int n,
+  BYTE *&Out_P) {
+  // one sample per frame in mono, the left one
+  if(Bits==8)
+  {
+    BYTE *p=Out_P;
+    for(int i=0;i<n*2;i+=2/Channels)
+    {
+      int val=frames[i];
+      if(val<VOLTAGE_FP(0))
+        val=VOLTAGE_FP(0);
+      else if(val>VOLTAGE_FP(255))
+        val=VOLTAGE_FP(255);
+      *p++=(BYTE)(val>>8);
+    }
+    Out_P=p;
+  }
+  else
+  {
+    short *p=(short*)Out_P;
+    for(int i=0;i<n*2;i+=2/Channels)
+    {
+      int val=frames[i];
+      if(val<-32768)
+        val=-32768;
+      else if(val>32767)
+        val=32767;
+      *p++=(short)val;
+    }
+    Out_P=(BYTE*)p;
+  }
+}
+
+
+template<int Alter_V> PSOUNDMIX SoundSelectMix(int Mix) {
+  switch(Mix) {
+  case SOUND_MIX_RAW:
+    return SoundMix<Alter_V,SOUND_MIX_RAW>;
+  case SOUND_MIX_STE:
+    return SoundMix<Alter_V,SOUND_MIX_STE>;
+  case SOUND_MIX_MICROWIRE:
+    return SoundMix<Alter_V,SOUND_MIX_MICROWIRE>;
+  case SOUND_MIX_DMA_ONLY:
+    return SoundMix<Alter_V,SOUND_MIX_DMA_ONLY>;
+  case SOUND_MIX_PROSOUND:
+    return SoundMix<Alter_V,SOUND_MIX_PROSOUND>;
+  default:
+    return SoundMix<Alter_V,SOUND_MIX_STF>;
+  }
+}
+
+
+TSoundKernel SoundSelectKernel(int Alter_V) {
+  TSoundKernel Kernel;
+  int mix;
+  Kernel.Microwire=(IS_STE&&OPTION_MICROWIRE);
+  if(sound_num_bits==8)
+    mix=SOUND_MIX_RAW;
+  else if(Kernel.Microwire) // most complex
+    mix=SOUND_MIX_MICROWIRE;
+  else if(IS_STE)
+    mix=SOUND_MIX_STE;
+#if defined(SSE_SOUND_CARTRIDGE)
+  else if(SSEConfig.mv16||SSEConfig.mr16)
+    mix=SOUND_MIX_DMA_ONLY;
+  else if(DONGLE_ID==TDongle::PROSOUND)
+    mix=SOUND_MIX_PROSOUND;
+#endif
+  else // STF PSG-only
+    mix=SOUND_MIX_STF;
+  switch(Alter_V) {
+  case CALC_V_CHIP:
+    Kernel.Mix=SoundSelectMix<CALC_V_CHIP>(mix);
+    break;
+  case CALC_V_CHIP_25KHZ:
+    Kernel.Mix=SoundSelectMix<CALC_V_CHIP_25KHZ>(mix);
+    break;
+  default:
+    Kernel.Mix=SoundSelectMix<CALC_V_EMU>(mix);
+    break;
+  }
+  if(sound_num_bits==8)
+    Kernel.Pack=(sound_num_channels==2) ? SoundPack<8,2> : SoundPack<8,1>;
+  else
+    Kernel.Pack=(sound_num_channels==2) ? SoundPack<16,2> : SoundPack<16,1>;
+  return Kernel;
+}
+
+
+void WriteSoundLoop(const TSoundKernel &Kernel,BYTE *&Out_P,int &c,int &v,
+  int &dv,int *&source_p,WORD *&lp_ste_sound_channel,
+  WORD *lp_max_ste_sound_channel) {
 /*  Try to avoid clicks when a program aggressively changes microwire volume
     (Sea of Colour).
     Now it won't work if a program does a lot of quick changes for effect.
     This is enabled with option Hacks, else we use dsp.
 */
+  BENCH_SCOPE(MIX);
   if(!IS_STE||!OPTION_MICROWIRE||!OPTION_HACKS)
     ;
   else if(Microwire.old_top_val_l<Microwire.top_val_l)
@@ -1175,224 +1436,49 @@ void WriteSoundLoop(int Alter_V, int* Out_P,int Size,int& c,int &val,
     Microwire.old_top_val_r++;
   else if(Microwire.old_top_val_r>Microwire.top_val_r)
     Microwire.old_top_val_r--;
-  // check size once
-  if(Size==sizeof(BYTE)) //8bit
-  {
-    while(c>0)
-    {       
-      AlterV(Alter_V,v,dv,*source_p);
-      //LEFT-8bit
-      val=v+(**lp_ste_sound_channel);                           
-      if(IS_STE&&OPTION_MICROWIRE)
-      { 
-        Microwire.Process(0,val);
-        if(OPTION_HACKS && sound_num_channels==2 // not for monosound: Rebirth
-          && (Microwire.top_val_l!=128
-          ||Microwire.old_top_val_l!=Microwire.top_val_l))
-        {
-          val*=Microwire.old_top_val_l;
-          val/=128;
-        }
-      }
-      if(val<VOLTAGE_FP(0))
-        val=VOLTAGE_FP(0); 
-      else if(val>VOLTAGE_FP(255))
-        val=VOLTAGE_FP(255); 
-      *(BYTE*)*(BYTE**)Out_P=(BYTE)((val&0x00FF00)>>8);
-      (*(BYTE**)Out_P)++;
-      // stereo: do the same for right channel
-      if(sound_num_channels==2) 
-      {   
-        //RIGHT-8bit
-        val=v+(*(*lp_ste_sound_channel+1)); 
-        if(IS_STE&&OPTION_MICROWIRE)
-        {
-          Microwire.Process(1,val);
-          if(OPTION_HACKS && (Microwire.top_val_r!=128 
-            || Microwire.old_top_val_r!=Microwire.top_val_r))
-          {
-            val*=Microwire.old_top_val_r;
-            val/=128;
-          }
-        }
-        if(val<VOLTAGE_FP(0))
-          val=VOLTAGE_FP(0); 
-        else if(val>VOLTAGE_FP(255))
-          val=VOLTAGE_FP(255); 
-        *(BYTE*)*(BYTE**)Out_P=(BYTE)((val&0x00FF00)>>8);
-        (* (BYTE**)Out_P )++;
-      }//right channel 
-      WAVEFORM_ONLY(temp_waveform_display[((int)(*source_p-psg_channels_buf)+psg_time_of_last_vbl_for_writing) % MAX_temp_waveform_display_counter]=WORD_B_1(&val)); 
-      *(*source_p)++=0;//VOLTAGE_FP(VOLTAGE_ZERO_LEVEL);
-      if(*lp_ste_sound_channel<*lp_max_ste_sound_channel) 
-        *lp_ste_sound_channel+=2;
-      c--;                                                          
-    }//wend
-  }
-  else //16bit
-  { // choose our loop according to config
-    if(IS_STE&&OPTION_MICROWIRE) // most complex
+  // not for monosound: Rebirth
+  bool hack=(Kernel.Microwire&&OPTION_HACKS&&sound_num_channels==2);
+  int top_val_l=(hack && (Microwire.top_val_l!=128
+    ||Microwire.old_top_val_l!=Microwire.top_val_l))
+    ? Microwire.old_top_val_l : 128;
+  int top_val_r=(hack && (Microwire.top_val_r!=128
+    ||Microwire.old_top_val_r!=Microwire.top_val_r))
+    ? Microwire.old_top_val_r : 128;
+  int frames[TLMC1992::BLOCK_FRAMES*2];
+  while(c>0)
+  {
+    int n=MIN(c,(int)TLMC1992::BLOCK_FRAMES);
+    Kernel.Mix(frames,n,v,dv,source_p,lp_ste_sound_channel,
+      lp_max_ste_sound_channel);
+    if(Kernel.Microwire)
     {
-      const int DMA_SOUND_MULTIPLIER=64; 
-      while(c>0)
-      { 
-        AlterV(Alter_V,v,dv,*source_p);
-        //LEFT-16bit
-        val=v; //inefficient?
-        char dma_sample_l=(char)**lp_ste_sound_channel; 
-        val+=dma_sample_l*DMA_SOUND_MULTIPLIER;
-        Microwire.Process(0,val);
-        if(OPTION_HACKS&&((Microwire.top_val_l!=128||Microwire.old_top_val_l
-          !=Microwire.top_val_l)&&sound_num_channels==2))
+      {
+        BENCH_SCOPE(MICROWIRE);
+        Microwire.Process(frames,n);
+      }
+      if(top_val_l!=128||top_val_r!=128)
+      {
+        for(int i=0;i<n*2;i+=2)
         {
-            val*=Microwire.old_top_val_l;
-            val/=128;
+          frames[i]=frames[i]*top_val_l/128;
+          frames[i+1]=frames[i+1]*top_val_r/128;
         }
-        if(val>32767)
-          val=32767;
-        *(WORD*)*(WORD**)Out_P=((WORD)val);
-        (*(WORD**)Out_P)++;
-        // stereo: do the same for right channel
-        if(sound_num_channels==2)
-        { //RIGHT-16bit
-          val=v;
-          char dma_sample_r=(char)*(*lp_ste_sound_channel+1);
-          val+=dma_sample_r*DMA_SOUND_MULTIPLIER;
-          Microwire.Process(1,val);
-          if(OPTION_HACKS&&(Microwire.top_val_r<128||Microwire.old_top_val_r
-            !=Microwire.top_val_r))
-          {
-            val*=Microwire.old_top_val_r;
-            val/=128;
-          }
-          if(val>32767)
-            val=32767;
-          *(WORD*)*(WORD**)Out_P=((WORD)val);
-          (*(WORD**)Out_P)++;
-        }
-        WAVEFORM_ONLY(temp_waveform_display[((int)(*source_p-psg_channels_buf)+psg_time_of_last_vbl_for_writing) % MAX_temp_waveform_display_counter]=WORD_B_1(&val)); 
-        *(*source_p)++=0;//VOLTAGE_FP(VOLTAGE_ZERO_LEVEL);
-        if(*lp_ste_sound_channel<*lp_max_ste_sound_channel) 
-          *lp_ste_sound_channel+=2;
-        c--;                                                          
-      }//wend
-    }
-    else if(IS_STE)
-    {
-      const int DMA_SOUND_MULTIPLIER=32;
-      while(c>0)
-      { 
-        AlterV(Alter_V,v,dv,*source_p);
-        //LEFT-16bit
-        val=v; //inefficient?
-        char dma_sample_l=(char)**lp_ste_sound_channel; 
-        val+=dma_sample_l*DMA_SOUND_MULTIPLIER;
-        if(val>32767)
-          val=32767;
-        *(WORD*)*(WORD**)Out_P=((WORD)val);
-        (*(WORD**)Out_P)++;
-        // stereo: do the same for right channel
-        if(sound_num_channels==2)
-        { //RIGHT-16bit
-          val=v;
-          char dma_sample_r=(char)*(*lp_ste_sound_channel+1);
-          val+=dma_sample_r*DMA_SOUND_MULTIPLIER;
-          if(val>32767)
-            val=32767;
-          *(WORD*)*(WORD**)Out_P=((WORD)val);
-          (*(WORD**)Out_P)++;
-        }
-        WAVEFORM_ONLY(temp_waveform_display[((int)(*source_p-psg_channels_buf)+psg_time_of_last_vbl_for_writing) % MAX_temp_waveform_display_counter]=WORD_B_1(&val)); 
-        *(*source_p)++=0;//VOLTAGE_FP(VOLTAGE_ZERO_LEVEL);
-        if(*lp_ste_sound_channel<*lp_max_ste_sound_channel) 
-          *lp_ste_sound_channel+=2;
-        c--;                                                          
-      }//wend
-    }
-#if defined(SSE_SOUND_CARTRIDGE)
-    else if(SSEConfig.mv16||SSEConfig.mr16)
-    { // B.A.T's MV16 cartridge, Action Replay 16, no PSG
-      //int snd_multiplier=(SSEConfig.mr16)?1:16; // see POV129
-      while(c>0)
-      { 
-        //LEFT-16bit
-        WORD dma_sample_l=**lp_ste_sound_channel; 
-        *(WORD*)*(WORD**)Out_P=dma_sample_l;
-        (*(WORD**)Out_P)++;
-        // stereo: do the same for right channel
-        if(sound_num_channels==2)
-        { //RIGHT-16bit
-          WORD dma_sample_r=*(*lp_ste_sound_channel+1);
-          *(WORD*)*(WORD**)Out_P=dma_sample_r;
-          (*(WORD**)Out_P)++;
-        }
-        if(*lp_ste_sound_channel<*lp_max_ste_sound_channel) 
-          *lp_ste_sound_channel+=2;
-        c--;                                                          
-      }//wend
-    }
-    else if(DONGLE_ID==TDongle::PROSOUND) // Pro Sound Designer + psg
-    {
-      int snd_multiplier=8;
-      while(c>0)
-      { 
-        AlterV(Alter_V,v,dv,*source_p);
-        val=v;
-        WORD dma_sample_l=**lp_ste_sound_channel; 
-        val+=dma_sample_l*snd_multiplier;
-        //LEFT-16bit
-        if(val>32767)
-          val=32767;
-        *(WORD*)*(WORD**)Out_P=((WORD)val);
-        (*(WORD**)Out_P)++;
-        // stereo: do the same for right channel
-        if(sound_num_channels==2)
-        { //RIGHT-16bit
-          val=v;
-          WORD dma_sample_r=*(*lp_ste_sound_channel+1);
-          val+=dma_sample_r*snd_multiplier;
-          *(WORD*)*(WORD**)Out_P=((WORD)val);
-          (*(WORD**)Out_P)++;
-        }
-        WAVEFORM_ONLY(temp_waveform_display[((int)(*source_p-psg_channels_buf)+psg_time_of_last_vbl_for_writing) % MAX_temp_waveform_display_counter]=WORD_B_1(&val)); 
-        *(*source_p)++=0;//VOLTAGE_FP(VOLTAGE_ZERO_LEVEL);
-        if(*lp_ste_sound_channel<*lp_max_ste_sound_channel) 
-          *lp_ste_sound_channel+=2;
-        c--;                                                          
-      }//wend
-    }
-#endif
-    else // STF PSG-only
-    {
-      while(c>0)
-      { 
-        AlterV(Alter_V,v,dv,*source_p);
-        //LEFT-16bit
-        if(v>32767)
-          v=32767;
-        *(WORD*)*(WORD**)Out_P=((WORD)v);
-        (*(WORD**)Out_P)++;
-        // stereo: do the same for right channel
-        if(sound_num_channels==2) // guess this test is assumed by the processor?
-        { //RIGHT-16bit
-          *(WORD*)*(WORD**)Out_P=((WORD)v);
-          (*(WORD**)Out_P)++;
-        }
-        WAVEFORM_ONLY(temp_waveform_display[((int)(*source_p-psg_channels_buf)+psg_time_of_last_vbl_for_writing) % MAX_temp_waveform_display_counter]=WORD_B_1(&val)); 
-        *(*source_p)++=0;//VOLTAGE_FP(VOLTAGE_ZERO_LEVEL);
-        c--;                                                          
-      }//wend
+      }
     }
-
-  }    
+    Kernel.Pack(frames,n,Out_P);
+    c-=n;
+  }
 }
 
-#define WRITE_SOUND_LOOP(Alter_V,Out_P,Size,GetSize) \
-  WriteSoundLoop(Alter_V,(int*)&Out_P,sizeof(Size),c,val,v,dv,&source_p,\
-  &lp_ste_sound_channel,&lp_max_ste_sound_channel)
 #define WRITE_TO_WAV_FILE_B 1 
 #define WRITE_TO_WAV_FILE_W 2 
 
+#if defined(SSE_SOUND_RECORD_THREAD)
+#define SOUND_RECORD_PUT(b) SoundRecorder.Put(b)
+#else
+#define SOUND_RECORD_PUT(b) fputc(b,wav_file)
+#endif
+
 void SoundRecord(int Alter_V, int Write,int& c,int &val,
   int &v,int &dv,int **source_p,WORD**lp_ste_sound_channel,
   WORD**lp_max_ste_sound_channel,FILE* wav_file) {
@@ -1426,9 +1512,23 @@ void SoundRecord(int Alter_V, int Write,int& c,int &val,
     }
     else
       val+= (**lp_ste_sound_channel);  
+    int frame[2]={val,v};
+    if(RENDER_SIGNED_SAMPLES)
+    {
+      WORD dma_sample_r=*(*lp_ste_sound_channel+1); 
+#if defined(SSE_SOUND_CARTRIDGE)
+      frame[1]+=(SSEConfig.mv16||SSEConfig.mr16||(DONGLE_ID==TDongle::PROSOUND))
+        ? dma_sample_r : ((char)dma_sample_r*32);
+#else
+      frame[1]+=dma_sample_r*DMA_SOUND_MULTIPLIER;
+#endif
+    }
+    else
+      frame[1]+= (*(*lp_ste_sound_channel+1)); 
     if(IS_STE&&OPTION_MICROWIRE)
     {
-      Microwire.Process(0,val);
+      Microwire.Process(frame,1,TLMC1992::RECORD);
+      val=frame[0];
       if(OPTION_HACKS&&((Microwire.top_val_l!=128||Microwire.old_top_val_l
         !=Microwire.top_val_l)&&sound_num_channels==2))
       {
@@ -1439,30 +1539,17 @@ void SoundRecord(int Alter_V, int Write,int& c,int &val,
     if(val>32767)
       val=32767;
     if(Write==WRITE_TO_WAV_FILE_B) 
-      fputc(BYTE(WORD_B_1(&(val))),wav_file);
+      SOUND_RECORD_PUT(BYTE(WORD_B_1(&(val))));
     else 
     {
-      fputc(LOBYTE(val),wav_file);
-      fputc(HIBYTE(val),wav_file);
+      SOUND_RECORD_PUT(LOBYTE(val));
+      SOUND_RECORD_PUT(HIBYTE(val));
     }
     if(sound_num_channels==2)
     { // RIGHT CHANNEL
-      val=v; // restore val! 
-      if(RENDER_SIGNED_SAMPLES)
-      {
-        WORD dma_sample_r=*(*lp_ste_sound_channel+1); 
-#if defined(SSE_SOUND_CARTRIDGE)
-        val+=(SSEConfig.mv16||SSEConfig.mr16||(DONGLE_ID==TDongle::PROSOUND))
-          ? dma_sample_r : ((char)dma_sample_r*32);
-#else
-        val+=dma_sample_r*DMA_SOUND_MULTIPLIER;
-#endif
-      }
-      else
-        val+= (*(*lp_ste_sound_channel+1)); 
+      val=frame[1];
       if(IS_STE&&OPTION_MICROWIRE)
       {
-        Microwire.Process(1,val);
         if(OPTION_HACKS&&(Microwire.top_val_r!=128||Microwire.old_top_val_r
           !=Microwire.top_val_r))
         {
@@ -1473,11 +1560,11 @@ void SoundRecord(int Alter_V, int Write,int& c,int &val,
       if(val>32767)
         val=32767;
       if(Write==WRITE_TO_WAV_FILE_B) 
-        fputc(BYTE(WORD_B_1(&(val))),wav_file);
+        SOUND_RECORD_PUT(BYTE(WORD_B_1(&(val))));
       else 
       {
-        fputc(LOBYTE(val),wav_file);
-        fputc(HIBYTE(val),wav_file);
+        SOUND_RECORD_PUT(LOBYTE(val));
+        SOUND_RECORD_PUT(HIBYTE(val));
       }
     }//right
     (*source_p)++; // don't zero! (or mute when recording)
@@ -1529,7 +1616,268 @@ void sound_record_to_wav(int c,DWORD SINE_ONLY(t),bool chipmode,int *source_p) {
 }
 
 
+#if defined(SSE_SOUND_ADAPTIVE_LATENCY)
+
+void TSoundLatency::Reset() {
+  Target=0; // set at first Update()
+}
+
+
+int TSoundLatency::Update(DWORD s_time,DWORD data_end,int samples_per_vbl,
+                          bool underrun) {
+/*  data_end is where the data of the last VBL ends (the rest is the
+    PSG_WRITE_EXTRA filler), fill is what's left of it when we're called.
+    If it went negative, or the callback ran out of data, it's an underrun.
+    Jitter is how much the play cursor moved more or less than one screen,
+    it tells how irregularly the device takes data.
+    DirectSound has no callback, the write cursor is already past what the
+    device holds. On UNIX, the callback takes a block of rt_buffer_size or
+    pa_output_buffer_size samples at once, that's the least we can keep.
+*/
+  int device_block=0;
+#ifdef UNIX
+  RT_ONLY( if(x_sound_lib==XS_RT) device_block=rt_buffer_size; )
+  PA_ONLY( if(x_sound_lib==XS_PA) device_block=pa_output_buffer_size; )
+#endif
+  int min_target=samples_per_vbl+device_block;
+  int max_target=MAX(samples_per_vbl*psg_write_n_screens_ahead,min_target);
+  int fill=(int)(data_end-s_time);
+  int jitter=abs((int)(s_time-LastTime)-samples_per_vbl);
+  LastTime=s_time;
+  if(!Target)
+  {
+    Target=max_target;
+    MinFill=INT_MAX;
+    MaxJitter=nVbl=0;
+    return Target;
+  }
+  MaxJitter=MAX(MaxJitter,jitter);
+  if(underrun || fill<0)
+  {
+    Target=MIN(Target+samples_per_vbl/2,max_target);
+#if defined(SSE_STATS)
+    Stats.nSoundUnderrun++;
+#endif
+    MinFill=INT_MAX; // new window
+    MaxJitter=nVbl=0;
+  }
+  else
+  {
+    MinFill=MIN(MinFill,fill);
+    if(++nVbl>=WINDOW)
+    {
+      int margin=samples_per_vbl/8;
+      if(MinFill>margin)
+        Target-=MIN(MinFill-margin,samples_per_vbl/8);
+#if defined(SSE_STATS)
+      Stats.SoundFillMin=MinFill;
+      Stats.SoundJitter=MaxJitter;
+#endif
+      MinFill=INT_MAX;
+      MaxJitter=nVbl=0;
+    }
+  }
+  Target=MAX(MIN(Target,max_target),min_target);
+#if defined(SSE_STATS)
+  Stats.SoundFill=fill;
+  Stats.SoundTarget=Target;
+#endif
+  return Target;
+}
+
+#endif
+
+
+#if defined(SSE_SOUND_DRC)
+
+void TSoundDrc::Reset() {
+  Error=0;
+  Ppm=Frac=0;
+  sound_freq_drc=sound_freq;
+#if defined(SSE_YM2149_LL)
+  if(sound_freq)
+    Psg.ym2149_cycles_per_sample=((double)CpuNormalHz/4)/(double)sound_freq;
+#endif
+}
+
+
+void TSoundDrc::Update(int error,int samples_per_vbl) {
+/*  error is where the data should end minus where it does, in samples.
+    It's low-passed because the play cursor moves by device blocks, then a
+    full screen of error gives the full deviation.
+*/
+  if(!samples_per_vbl)
+    return;
+  Error+=(error-Error)/SMOOTHING;
+  double x=Error/samples_per_vbl;
+  if(x>1)
+    x=1;
+  else if(x<-1)
+    x=-1;
+  Ppm=(int)(x*MAX_PPM);
+  sound_freq_drc=sound_freq+(int)((LONGLONG)sound_freq*Ppm/1000000);
+#if defined(SSE_YM2149_LL)
+  Psg.ym2149_cycles_per_sample=((double)CpuNormalHz/4)/(double)sound_freq_drc;
+#endif
+#if defined(SSE_STATS)
+  Stats.SoundDrcPpm=Ppm;
+#endif
+}
+
+
+int TSoundDrc::SamplesThisVbl(int video_freq) {
+  // keep the remainder, 71Hz doesn't divide
+  Frac+=sound_freq_drc*SCREENS_PER_SOUND_VBL;
+  int n=Frac/video_freq;
+  Frac%=video_freq;
+  return n;
+}
+
+#endif
+
+
+#if defined(SSE_SOUND_PROFILE)
+
+TSoundProfile::TSoundProfile() {
+  Csv=NULL;
+  Mode=OFF;
+  nProbes=0;
+  DeviceUs=OutputUs=0;
+  ProbeArmed=false;
+  OsdText[0]='\0';
+}
+
+
+TSoundProfile::~TSoundProfile() {
+  Stop();
+}
+
+
+void TSoundProfile::Reset() {
+#if !defined(STEEM_BENCH) // else the bench runner times
+  if(Mode)
+    Bench.Start();
+#endif
+  if(Bench.Active)
+    Bench.Switch(Bench.Current); // up to now
+  for(int i=0;i<TBenchmark::NSOUNDSTAGES;i++)
+    StageTime[i]=Bench.SubsystemTime[TBenchmark::PSG+i];
+  SecondTicks=Bench.LastSwitch;
+  SecondUs=TBenchmark::SystemUs();
+  ProbeDeviceTicks=ProbeOutputSamples=0;
+  nProbes=0;
+  DeviceUs=OutputUs=0;
+  ProbeArmed=false;
+  OsdText[0]='\0';
+}
+
+
+void TSoundProfile::Stop() {
+#if !defined(STEEM_BENCH)
+  Bench.Active=false;
+#endif
+  if(Csv)
+  {
+    fclose(Csv);
+    Csv=NULL;
+  }
+  OsdText[0]='\0';
+}
+
+
+void TSoundProfile::ArmProbe(DWORD sample) {
+  // one probe at a time, it's a sample, not a trace
+  if(ProbeArmed)
+    return;
+  ProbeSample=sample;
+  ProbeTicks=TBenchmark::Now();
+  ProbeArmed=true;
+}
+
+
+void TSoundProfile::CheckProbe(DWORD written_to,DWORD play_cursor) {
+  // written_to is the first sample not handed to the device yet
+  if(!ProbeArmed || (int)(ProbeSample-written_to)>=0)
+    return;
+  ProbeDeviceTicks+=TBenchmark::Now()-ProbeTicks;
+  if((int)(ProbeSample-play_cursor)>0)
+    ProbeOutputSamples+=ProbeSample-play_cursor;
+  nProbes++;
+  ProbeArmed=false;
+}
+
+
+void TSoundProfile::Vbl() {
+  enum {PSG,ANTIALIAS,MICROWIRE,MIX,DEVICE}; // index of the stages
+  unsigned long long now_us=TBenchmark::SystemUs();
+  unsigned long long elapsed_us=now_us-SecondUs;
+  if(elapsed_us<1000000)
+    return;
+  Bench.Switch(Bench.Current); // up to now
+  double ticks_per_us=(double)(Bench.LastSwitch-SecondTicks)
+    /(double)elapsed_us;
+  if(ticks_per_us<=0)
+    ticks_per_us=1;
+  int us[TBenchmark::NSOUNDSTAGES],total_us=0; // per second
+  for(int i=0;i<TBenchmark::NSOUNDSTAGES;i++)
+  {
+    unsigned long long t=Bench.SubsystemTime[TBenchmark::PSG+i];
+    us[i]=(int)((double)(t-StageTime[i])/ticks_per_us*1000000.0
+      /(double)elapsed_us);
+    total_us+=us[i];
+    StageTime[i]=t;
+  }
+  if(nProbes)
+  {
+    DeviceUs=(int)((double)ProbeDeviceTicks/ticks_per_us/nProbes);
+    OutputUs=DeviceUs;
+    if(sound_freq)
+      OutputUs+=(int)(ProbeOutputSamples*1000000ull/sound_freq/nProbes);
+  }
+#if defined(SSE_STATS)
+  for(int i=0;i<TBenchmark::NSOUNDSTAGES;i++)
+    Stats.SoundStageUs[i]=us[i];
+  Stats.SoundProbeDeviceUs=DeviceUs;
+  Stats.SoundProbeOutputUs=OutputUs;
+#endif
+  // the OSD font has no lower case; % of a second, latency to the speaker
+  char text[80];
+  sprintf(text,"PSG%d.%d AA%d.%d MW%d.%d MX%d.%d DV%d.%d %dMS",
+    us[PSG]/10000,us[PSG]/1000%10,us[ANTIALIAS]/10000,us[ANTIALIAS]/1000%10,
+    us[MICROWIRE]/10000,us[MICROWIRE]/1000%10,us[MIX]/10000,us[MIX]/1000%10,
+    us[DEVICE]/10000,us[DEVICE]/1000%10,OutputUs/1000);
+  strncpy(OsdText,text,OSD_MESSAGE_LENGTH);
+  OsdText[OSD_MESSAGE_LENGTH]='\0';
+  if(Mode==CSV)
+  {
+    if(!Csv)
+    {
+      nSeconds=0;
+      Csv=fopen((RunDir+SLASH+SOUND_PROFILE_FILENAME).Text,"w");
+      if(Csv)
+        fprintf(Csv,"second,psg_us,antialias_us,microwire_us,mix_us,"
+          "device_us,total_us,probes,latency_device_us,latency_output_us\n");
+    }
+    if(Csv)
+    {
+      fprintf(Csv,"%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n",nSeconds,us[PSG],
+        us[ANTIALIAS],us[MICROWIRE],us[MIX],us[DEVICE],total_us,nProbes,
+        DeviceUs,OutputUs);
+      fflush(Csv); // can be read while running
+    }
+  }
+  nSeconds++;
+  SecondTicks=Bench.LastSwitch;
+  SecondUs=now_us;
+  ProbeDeviceTicks=ProbeOutputSamples=0;
+  nProbes=0;
+}
+
+#endif
+
+
 HRESULT Sound_VBL() {
+  BENCH_SCOPE(SOUND);
 #if SCREENS_PER_SOUND_VBL != 1 //SS it is 1
   static int screens_countdown=SCREENS_PER_SOUND_VBL;
   screens_countdown--;if(screens_countdown>0) return DD_OK;
@@ -1597,7 +1945,23 @@ HRESULT Sound_VBL() {
   int *source_p;
   DWORD n_samples_per_vbl=(sound_freq*SCREENS_PER_SOUND_VBL)/Glue.video_freq;
   DBG_LOG(EasyStr("SOUND: Calculating time; psg_time_of_start_of_buffer=")+psg_time_of_start_of_buffer);
-  s_time=SoundGetTime();
+  {
+    BENCH_SCOPE(DEVICE);
+    s_time=SoundGetTime();
+  }
+#if defined(SSE_SOUND_ADAPTIVE_LATENCY)
+  bool underrun=false;
+#ifdef UNIX
+  underrun=(thread_atomic_int_swap(&x_sound_underrun,0)>0);
+#endif
+  DWORD samples_ahead=SoundLatency.Update(s_time,
+    psg_time_of_last_vbl_for_writing,n_samples_per_vbl,underrun);
+  // a screen late at most, more would be a lasting latency
+  DWORD max_samples_ahead=samples_ahead+n_samples_per_vbl;
+#else
+  DWORD samples_ahead=n_samples_per_vbl*psg_write_n_screens_ahead;
+  DWORD max_samples_ahead=n_samples_per_vbl*(psg_write_n_screens_ahead+2);
+#endif
   //we have data from time_of_last_vbl+PSG_WRITE_N_SCREENS_AHEAD*n_samples_per_vbl up to
   //wherever we want
   write_time_1=psg_time_of_last_vbl_for_writing; //3 screens ahead of where the cursor was
@@ -1607,11 +1971,24 @@ HRESULT Sound_VBL() {
   if((write_time_2-write_time_1)>PSG_CHANNEL_BUF_LENGTH)
     write_time_2=write_time_1+PSG_CHANNEL_BUF_LENGTH;
   //psg_last_write_time=write_time_2;
-  DWORD time_of_next_vbl_to_write=MAX(s_time+n_samples_per_vbl*psg_write_n_screens_ahead,psg_time_of_next_vbl_for_writing);
-  if(time_of_next_vbl_to_write>s_time+n_samples_per_vbl
-    *(psg_write_n_screens_ahead+2))
-    time_of_next_vbl_to_write=s_time+n_samples_per_vbl
-    *(psg_write_n_screens_ahead+2); // new bit added by Ant 9/1/2001 to stop the sound lagging behind
+#if defined(SSE_SOUND_DRC)
+  // jump only when rate control can't make it: the data would run out
+  // before next VBL, or it's too far ahead
+  DWORD time_of_next_vbl_to_write=psg_time_of_next_vbl_for_writing;
+  if((int)(time_of_next_vbl_to_write-s_time)<(int)n_samples_per_vbl
+    || (int)(time_of_next_vbl_to_write-s_time)>(int)max_samples_ahead)
+    time_of_next_vbl_to_write=s_time+samples_ahead;
+  int drc_error=(int)(s_time+samples_ahead-time_of_next_vbl_to_write);
+#else
+  DWORD time_of_next_vbl_to_write=MAX(s_time+samples_ahead,psg_time_of_next_vbl_for_writing);
+  if(time_of_next_vbl_to_write>s_time+max_samples_ahead)
+    time_of_next_vbl_to_write=s_time+max_samples_ahead; // new bit added by Ant 9/1/2001 to stop the sound lagging behind
+#endif
+#if defined(SSE_SOUND_ADAPTIVE_LATENCY) && defined(UNIX)
+  // The next write starts there, it mustn't go back into published samples
+  if((int)(time_of_next_vbl_to_write-write_time_1)<0)
+    time_of_next_vbl_to_write=write_time_1;
+#endif
   DBG_LOG(EasyStr("   writing from ")+write_time_1+" to "+write_time_2+"; current play cursor at "+s_time+" ("+play_cursor+"); minimum write at "+min_write_time+" ("+write_cursor+")");
 //  log_write(EasyStr("writing ")+(write_time_1-s_time)+" samples ahead of play cursor, "+(write_time_1-min_write_time)+" ahead of min write");
 #ifdef SHOW_WAVEFORM
@@ -1676,8 +2053,11 @@ HRESULT Sound_VBL() {
   DWORD StartByte=(write_time_1 MOD_PSG_BUF_LENGTH)*sound_bytes_per_sample;
   DWORD NumBytes=((write_time_2-write_time_1)+1)*sound_bytes_per_sample;
   DBG_LOG(EasyStr("SOUND: Trying to lock from ")+StartByte+", length "+NumBytes);
-  Ret=SoundLockBuffer(StartByte,NumBytes,&DatAdr[0],&LockLength[0],
-    &DatAdr[1],&LockLength[1]);
+  {
+    BENCH_SCOPE(DEVICE);
+    Ret=SoundLockBuffer(StartByte,NumBytes,&DatAdr[0],&LockLength[0],
+      &DatAdr[1],&LockLength[1]);
+  }
   if(Ret!=DSERR_BUFFERLOST)
   {
     if(Ret!=DS_OK)
@@ -1709,9 +2089,14 @@ HRESULT Sound_VBL() {
 /*  Each VBL we dump PSG registers. We must write the envelope register
     only if it was written to (even same value), otherwise we write $FF.
 */
-        fwrite(psg_reg,sizeof(BYTE),13,Wav_file);
         BYTE env=written_to_env_this_vbl?psg_reg[13]:0xFF;
+#if defined(SSE_SOUND_RECORD_THREAD)
+        SoundRecorder.Write(psg_reg,13);
+        SoundRecorder.Put(env);
+#else
+        fwrite(psg_reg,sizeof(BYTE),13,Wav_file);
         fwrite(&env,sizeof(BYTE),1,Wav_file);
+#endif
         written_to_env_this_vbl=false;
       }
       else
@@ -1724,19 +2109,18 @@ HRESULT Sound_VBL() {
 #ifdef WRITE_ONLY_SINE_WAVE
     DWORD t=write_time_1;
 #endif
-    int val;
     DBG_LOG("SOUND: Starting to write to buffers");
     WORD *lp_ste_sound_channel=ste_sound_channel_buf;
     WORD *lp_max_ste_sound_channel=ste_sound_channel_buf
       +ste_sound_channel_buf_idx;
     BYTE *pb;
-    WORD *pw;
+    TSoundKernel Kernel=SoundSelectKernel(chipmode ? (sound_low_quality
+      ? CALC_V_CHIP_25KHZ : CALC_V_CHIP) : CALC_V_EMU);
     for(int n=0;n<2;n++)
     {
       if(DatAdr[n])
       {
         pb=(BYTE*)(DatAdr[n]);
-        pw=(WORD*)(DatAdr[n]);
         int c=MIN(int(LockLength[n]/sound_bytes_per_sample),
           samples_left_in_buffer),oc=c;
         if(c>countdown_to_storing_values)
@@ -1747,31 +2131,8 @@ HRESULT Sound_VBL() {
         }
         for(;;)
         {
-          //TRACE("F%d WRITE_SOUND_LOOP\n",FRAME); 2-3/frame
-          if(sound_num_bits==8)
-          {
-            if(chipmode)
-            {
-              if(sound_low_quality==0)
-                WRITE_SOUND_LOOP(CALC_V_CHIP,pb,BYTE,DWORD_B_1);
-              else
-                WRITE_SOUND_LOOP(CALC_V_CHIP_25KHZ,pb,BYTE,DWORD_B_1);
-            }
-            else
-              WRITE_SOUND_LOOP(CALC_V_EMU,pb,BYTE,DWORD_B_1);
-          }
-          else
-          {
-            if(chipmode)
-            {
-              if(sound_low_quality==0)
-                WRITE_SOUND_LOOP(CALC_V_CHIP,pw,WORD,MSB_W ^ DWORD_W_0);
-              else
-                WRITE_SOUND_LOOP(CALC_V_CHIP_25KHZ,pw,WORD,MSB_W ^ DWORD_W_0);
-            }
-            else
-              WRITE_SOUND_LOOP(CALC_V_EMU,pw,WORD,MSB_W ^ DWORD_W_0);
-          }
+          WriteSoundLoop(Kernel,pb,c,v,dv,source_p,lp_ste_sound_channel,
+            lp_max_ste_sound_channel);
           if(store_values)
           {
             c=oc;
@@ -1793,19 +2154,44 @@ HRESULT Sound_VBL() {
     if(video_recording&&SoundBuf&&pAviFile&&pAviFile->Initialised)
       pAviFile->AppendSound(DatAdr[0],LockLength[0]);
 #endif
-    SoundUnlock(DatAdr[0],LockLength[0],DatAdr[1],LockLength[1]);
+    {
+      BENCH_SCOPE(DEVICE);
+      SoundUnlock(DatAdr[0],LockLength[0],DatAdr[1],LockLength[1]);
+#if defined(SSE_SOUND_ADAPTIVE_LATENCY) && defined(UNIX)
+      // publish what the next VBL won't rewrite, not the filler after it
+      int written=(int)time_of_next_vbl_to_write;
+      if(written-(int)(write_time_2+1)>0)
+        written=(int)(write_time_2+1);
+      thread_atomic_int_store(&sound_buf_written,written);
+#endif
+    }
+#if defined(SSE_SOUND_PROFILE)
+    if(SoundProfile.Mode)
+      SoundProfile.CheckProbe(write_time_2+1,s_time);
+#endif
     //ASSERT(source_p<=(psg_channels_buf+PSG_CHANNEL_BUF_LENGTH));
     while(source_p<(psg_channels_buf+PSG_CHANNEL_BUF_LENGTH))
       *(source_p++)=VOLTAGE_FP(VOLTAGE_ZERO_LEVEL); //zero the rest of the buffer
   }
   psg_buf_pointer[0]=psg_buf_pointer[1]=psg_buf_pointer[2]=0;
   psg_time_of_last_vbl_for_writing=time_of_next_vbl_to_write;
-  psg_time_of_next_vbl_for_writing=MAX(s_time+n_samples_per_vbl
-    *(psg_write_n_screens_ahead+1),time_of_next_vbl_to_write+n_samples_per_vbl);
+#if defined(SSE_SOUND_DRC)
+  // after the YM emu finished this frame at the old rate
+  SoundDrc.Update(drc_error,n_samples_per_vbl);
+  psg_time_of_next_vbl_for_writing=time_of_next_vbl_to_write
+    +SoundDrc.SamplesThisVbl(Glue.video_freq);
+#else
+  psg_time_of_next_vbl_for_writing=MAX(s_time+samples_ahead+n_samples_per_vbl,
+    time_of_next_vbl_to_write+n_samples_per_vbl);
+#endif
   psg_time_of_next_vbl_for_writing=MIN(psg_time_of_next_vbl_for_writing,
     s_time+(PSG_BUF_LENGTH/2));
   DBG_LOG(EasyStr("SOUND: psg_time_of_next_vbl_for_writing=")+psg_time_of_next_vbl_for_writing);
   psg_n_samples_this_vbl=psg_time_of_next_vbl_for_writing-psg_time_of_last_vbl_for_writing;
+#if defined(SSE_SOUND_PROFILE)
+  if(SoundProfile.Mode)
+    SoundProfile.Vbl();
+#endif
   DBG_LOG("SOUND: End of Sound_VBL");
   DBG_LOG("");
   return DS_OK;
@@ -1876,6 +2262,15 @@ HRESULT Sound_Start() { //Called from run()
 #endif
   psg_time_of_start_of_buffer=psg_last_play_cursor=0;
   psg_time_of_last_vbl_for_writing=psg_time_of_next_vbl_for_writing=0;
+#if defined(SSE_SOUND_ADAPTIVE_LATENCY)
+  SoundLatency.Reset();
+#endif
+#if defined(SSE_SOUND_DRC)
+  SoundDrc.Reset();
+#endif
+#if defined(SSE_SOUND_PROFILE)
+  SoundProfile.Reset();
+#endif
   for(int abc=2;abc>=0;abc--)
   {
     psg_buf_pointer[abc]=0;
@@ -1927,25 +2322,44 @@ void TLMC1992::Reset(bool Cold) { // there's no reset line
     top_val_l=128;
     top_val_r=128;
   }
+  tone_bass=tone_treble=0xFF; // compute coefficients before use
+  gain_volume=0xFF;
   StartTime=0;
   old_top_val_l=top_val_l;
   old_top_val_r=top_val_r;
 }
 
 
-void TLMC1992::Process(int channel,int &val) {
+void TLMC1992::Process(int *frames,int count,int stream) {
+/*  Coefficients and gains are computed again only when the Microwire
+    registers (or the sample rate) have changed.
+    Volume is a gain in dB: master -80..0 + left or right -40..0. With option
+    Hacks, it's done in the sound loop instead (old_top_val).
+*/
   if(DSP_DISABLED)
     return;
-  double d_dsp_v=val;
-  if(bass!=6)
-    d_dsp_v=MicrowireBass[channel].FilterAudio(d_dsp_v,MW_LOW_SHELF_FREQ,
-      bass-6);
-  if(treble!=6)
-    d_dsp_v=MicrowireTreble[channel].FilterAudio(d_dsp_v,MW_HIGH_SHELF_FREQ,
-     treble-6);
-  if(!OPTION_HACKS && (volume<0x28||volume_l<0x14 &&!channel 
-    ||volume_r<0x14 &&channel))//3.6.1: 2 channels
-    d_dsp_v=MicrowireVolume[channel].FilterAudio(d_dsp_v,volume-0x28
-      + ( (channel) ? (volume_r-0x14) : (volume_l-0x14)));
-  val=(int)d_dsp_v;
+  if(bass!=tone_bass||treble!=tone_treble||SampleRate!=tone_sample_rate)
+  {
+    tone_bass=bass;
+    tone_treble=treble;
+    tone_sample_rate=SampleRate;
+    for(int i=0;i<NSTREAMS;i++)
+      Tone[i].SetTone(MW_LOW_SHELF_FREQ,bass-6,MW_HIGH_SHELF_FREQ,treble-6);
+  }
+  if(volume!=gain_volume||volume_l!=gain_volume_l||volume_r!=gain_volume_r)
+  {
+    gain_volume=volume;
+    gain_volume_l=volume_l;
+    gain_volume_r=volume_r;
+    gain_l=(float)pow(10.0,(volume-0x28+volume_l-0x14)/20.0);
+    gain_r=(float)pow(10.0,(volume-0x28+volume_r-0x14)/20.0);
+  }
+  bool gain_neutral=(OPTION_HACKS
+    ||volume==0x28&&volume_l==0x14&&volume_r==0x14);
+  if(bass==6&&treble==6&&gain_neutral)
+    return;
+  if(gain_neutral)
+    Tone[stream].Process(frames,count,1.0f,1.0f);
+  else
+    Tone[stream].Process(frames,count,gain_l,gain_r);
 }
@@ -0,0 +1,169 @@
+/*---------------------------------------------------------------------------
+PROJECT: Steem SSE
+Atari ST emulator
+Copyright (C) 2020 by Anthony Hayward and Russel Hayward + SSE
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see https://www.gnu.org/licenses/.
+
+DOMAIN: Sound
+FILE: sound_record.cpp
+DESCRIPTION: Sound recorder. The emulator used to fputc() every byte of the
+recording from Sound_VBL(), now it only copies them into blocks of 32KB.
+Full blocks go to a writer thread through a bounded queue (thread.h),
+which writes them to disk, or compresses them first for FLAC, and gives
+them back through another queue. If the disk can't keep up, the emulator
+waits for a free block, so memory use is bounded.
+Headers (WAV, YM) are still handled in sound.cpp once the thread is done.
+struct TSoundRecorder
+---------------------------------------------------------------------------*/
+
+#include "pch.h"
+#pragma hdrstop
+
+#if defined(SSE_SOUND_RECORD_THREAD)
+
+#include <sound_record.h>
+#include <flac.h>
+#include <options.h>
+
+TSoundRecorder SoundRecorder;
+
+
+TSoundRecorder::TSoundRecorder() {
+  for(int i=0;i<NBLOCKS;i++)
+    Block[i]=NULL;
+  Current=NULL;
+  Pos=End=NULL;
+  Thread=NULL;
+  File=NULL;
+  Flac=NULL;
+}
+
+
+TSoundRecorder::~TSoundRecorder() {
+  Stop();
+  for(int i=0;i<NBLOCKS;i++)
+    delete Block[i];
+}
+
+
+bool TSoundRecorder::Start(FILE *f,int format,int freq,int channels,int bits) {
+  if(Thread)
+    return false;
+  if(!Block[0]) // allocated at first recording
+  {
+    for(int i=0;i<NBLOCKS;i++)
+      Block[i]=new TSoundRecordBlock;
+  }
+  File=f;
+  Format=format;
+  Freq=freq;
+  nChannels=channels;
+  nBits=bits;
+  Error=false;
+  Current=Block[0];
+  Pos=Current->Data;
+  End=Pos+TSoundRecordBlock::SIZE;
+  for(int i=1;i<NBLOCKS;i++)
+    FreeValues[i-1]=Block[i];
+  thread_queue_init(&Full,NBLOCKS+1,FullValues,0); // +1 for the end mark
+  thread_queue_init(&Free,NBLOCKS,FreeValues,NBLOCKS-1);
+  Thread=thread_create(WriterThread,this,THREAD_STACK_SIZE_DEFAULT);
+  if(!Thread)
+  {
+    thread_queue_term(&Full);
+    thread_queue_term(&Free);
+    Pos=End=NULL;
+  }
+  return (Thread!=NULL);
+}
+
+
+bool TSoundRecorder::Stop() {
+  if(!Thread)
+    return true;
+  Current->nBytes=(int)(Pos-Current->Data);
+  thread_queue_produce(&Full,Current);
+  thread_queue_produce(&Full,NULL); // end mark
+  thread_join(Thread);
+  thread_destroy(Thread);
+  Thread=NULL;
+  thread_queue_term(&Full);
+  thread_queue_term(&Free);
+  Current=NULL;
+  Pos=End=NULL;
+  return !Error;
+}
+
+
+void TSoundRecorder::Flush() {
+/*  Hand the current block to the writer and take a free one. We only wait
+    here if the writer is NBLOCKS behind.
+*/
+  Current->nBytes=(int)(Pos-Current->Data);
+  thread_queue_produce(&Full,Current);
+  Current=(TSoundRecordBlock*)thread_queue_consume(&Free);
+  Pos=Current->Data;
+  End=Pos+TSoundRecordBlock::SIZE;
+}
+
+
+void TSoundRecorder::Write(const BYTE *p,int n) {
+  while(n>0)
+  {
+    int chunk=MIN(n,(int)(End-Pos));
+    memcpy(Pos,p,chunk);
+    Pos+=chunk;
+    p+=chunk;
+    n-=chunk;
+    if(Pos==End)
+      Flush();
+  }
+}
+
+
+int TSoundRecorder::WriterThread(void *p) {
+  return ((TSoundRecorder*)p)->Writer();
+}
+
+
+int TSoundRecorder::Writer() {
+  if(Format==TOption::SoundFormatFlac)
+  {
+    Flac=new TFlacEncoder;
+    Error=!Flac->Open(File,Freq,nChannels,nBits);
+  }
+  for(;;)
+  {
+    TSoundRecordBlock *block=(TSoundRecordBlock*)thread_queue_consume(&Full);
+    if(!block)
+      break;
+    if(Flac)
+      Flac->Write(block->Data,block->nBytes);
+    else if(fwrite(block->Data,1,block->nBytes,File)!=(size_t)block->nBytes)
+      Error=true;
+    thread_queue_produce(&Free,block);
+  }
+  if(Flac)
+  {
+    Flac->Close();
+    delete Flac;
+    Flac=NULL;
+  }
+  if(ferror(File))
+    Error=true;
+  return 0;
+}
+
+#endif//SSE_SOUND_RECORD_THREAD
@@ -435,6 +435,9 @@ LRESULT PASCAL WndProc(HWND Win,UINT Mess,WPARAM wPar,LPARAM lPar) {
   switch(Mess) {
   case WM_PAINT:
   {
+#if defined(SSE_VID_LINE_CACHE)
+    ScanlineCache.Dirty=true; // the host must show the picture again
+#endif
     RECT dest;
     GetClientRect(Win,&dest);
     int Height=dest.bottom;
@@ -1581,6 +1584,9 @@ LRESULT PASCAL WndProc(HWND Win,UINT Mess,WPARAM wPar,LPARAM lPar) {
 
   case WM_SIZE:
   {
+#if defined(SSE_VID_LINE_CACHE)
+    ScanlineCache.Dirty=true; // also after SIZE_RESTORED
+#endif
     int cw=LOWORD(lPar),ch=HIWORD(lPar);
     RECT rc={0,MENUHEIGHT,cw,ch};
     //TRACE("WM_SIZE ");TRACE_RECT(rc);
@@ -1647,6 +1653,11 @@ LRESULT PASCAL WndProc(HWND Win,UINT Mess,WPARAM wPar,LPARAM lPar) {
     break;
   }
 
+#if defined(SSE_VID_LINE_CACHE)
+  case WM_MOVE: // a skipped frame would leave the old position on screen
+    ScanlineCache.Dirty=true;
+    break;
+#endif
   case WM_DISPLAYCHANGE:
     if(FullScreen==0) 
     {
@@ -1678,6 +1689,9 @@ LRESULT PASCAL WndProc(HWND Win,UINT Mess,WPARAM wPar,LPARAM lPar) {
 
   case WM_ACTIVATEAPP:
     bAppActive=(wPar!=0);
+#if defined(SSE_VID_LINE_CACHE)
+    ScanlineCache.Dirty=true; // eg fullscreen restored
+#endif
     if(MuteWhenInactive && SoundBuf &&runstate==RUNSTATE_RUNNING)
     {
       DWORD dwStatus ;
@@ -2115,24 +2129,10 @@ void HandleButtonMessage(UINT Id,HWND hBut) {
 #endif
     }
 #ifdef STEEM_CRT    
-    thread_mutex_lock( &Disp.CRTmutex );
-
-    RECT dest;
-    GetClientRect(StemWin,&dest);
-
-    Disp.CRTviewy = ( FullScreen && runstate != RUNSTATE_RUNNING ) ? MENUHEIGHT / 2 : 0;
-    Disp.CRTvieww = dest.right - dest.left;
-    Disp.CRTviewh = dest.bottom - dest.top - ( ( FullScreen && runstate == RUNSTATE_RUNNING ) ? 0 : MENUHEIGHT );
-    if( FullScreen && runstate == RUNSTATE_RUNNING ) {
-        MoveWindow( Disp.CRThwnd, 0, 0, Disp.CRTvieww, Disp.CRTviewh, FALSE );
-        SetWindowLong( Disp.CRThwnd, GWL_STYLE, GetWindowLong( Disp.CRThwnd, GWL_STYLE ) & (~ WS_CLIPSIBLINGS ) ) ;  	
-    } else {
-        MoveWindow( Disp.CRThwnd, 0, MENUHEIGHT, Disp.CRTvieww, Disp.CRTviewh, FALSE );
-        SetWindowLong( Disp.CRThwnd, GWL_STYLE, GetWindowLong( Disp.CRThwnd, GWL_STYLE ) | WS_CLIPSIBLINGS ) ;  	
+    if( Disp.CRThwnd ) {
+        Disp.CRTUpdateView();
+        thread_signal_raise( &Disp.CRTframeSignal );
     }
-
-    thread_mutex_unlock( &Disp.CRTmutex );
-
 #endif
     break;
   case IDC_RESET:
@@ -2628,6 +2628,9 @@ int StemWinProc(void*,Window Win,XEvent *Ev)
   switch (Ev->type){
     case Expose:
     {
+#if defined(SSE_VID_LINE_CACHE)
+      ScanlineCache.Dirty=true; // if draw_blit() below fails
+#endif
       XWindowAttributes wa;
       XGetWindowAttributes(XD,StemWin,&wa);
 
@@ -2776,6 +2779,9 @@ int StemWinProc(void*,Window Win,XEvent *Ev)
       }
       bool OldCanUse=CanUse_400;
       if (draw_grille_black<10) draw_grille_black=10;
+#if defined(SSE_VID_LINE_CACHE)
+      ScanlineCache.Dirty=true; // moved or resized
+#endif
       if (border & 1){
         CanUse_400=(wa.width>=(2+BORDER_SIDE*2+640+BORDER_SIDE*2+2) &&
                       wa.height>=(MENUHEIGHT + 2+BORDER_TOP*2+400+BORDER_BOTTOM*2+2));
@@ -2833,6 +2839,9 @@ int StemWinProc(void*,Window Win,XEvent *Ev)
     case MapNotify:
 	  	bAppActive=true;
     	bAppMinimized=0;
+#if defined(SSE_VID_LINE_CACHE)
+      ScanlineCache.Dirty=true; // restored
+#endif
     	break;
     case UnmapNotify:
     	bAppMinimized=true;
@@ -1367,7 +1367,7 @@ void thread_queue_produce( thread_queue_t* queue, void* value )
             queue->id_produce = thread_current_thread_id();
         assert( thread_current_thread_id() == queue->id_produce );
     #endif
-    if( thread_atomic_int_load( &queue->count ) == queue->size )
+    while( thread_atomic_int_load( &queue->count ) == queue->size ) // the signal may be left over from before
         thread_signal_wait( &queue->space_open, THREAD_SIGNAL_WAIT_INFINITE );
     int tail = thread_atomic_int_inc( &queue->tail );
     queue->values[ tail % queue->size ] = value;
@@ -1383,7 +1383,7 @@ void* thread_queue_consume( thread_queue_t* queue )
             queue->id_consume = thread_current_thread_id();
         assert( thread_current_thread_id() == queue->id_consume );
     #endif
-    if( thread_atomic_int_load( &queue->count ) == 0 )
+    while( thread_atomic_int_load( &queue->count ) == 0 ) // the signal may be left over from before
         thread_signal_wait( &queue->data_ready, THREAD_SIGNAL_WAIT_INFINITE );
     int head = thread_atomic_int_inc( &queue->head );
     void* retval = queue->values[ head % queue->size ];